@@ -0,0 +1,217 @@
+#include "temple.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* ----------------------------------------------SERVICE----------------------------------------------------- */
+
+/**
+ * Minimal in-process consumer of libtemple, linked against the
+ * installed library. Each check returns EXIT_SUCCESS when passing.
+ */
+
+/**
+ * @brief Walk the temple, rejecting malformed words and escaping paths.
+ */
+static u_int8_t checkPath(void) {
+    char grid[5 * 5];
+
+    // Same path as the first words test.
+    if (Temple_Path("a7625 a1256 a2234 a1576 a1211\n", grid, 5, 5)) return EXIT_FAILURE;
+    if (grid[0] != 1 || grid[1] != 2 || grid[5] != 6 || grid[10] != 5) return EXIT_FAILURE;
+
+    // Moving right from the last column must not wrap to the next row.
+    if (!Temple_Path("a1000 a1000 a1000", grid, 2, 3)) return EXIT_FAILURE;
+
+    // Malformed 'c' words: zero length, too few digits.
+    if (!Temple_Path("c0123", grid, 3, 3)) return EXIT_FAILURE;
+    if (!Temple_Path("c92", grid, 3, 3)) return EXIT_FAILURE;
+
+    // Paths longer than a cell can number are refused.
+    char code[1024];
+    code[0] = '\0';
+    for (int i = 0; i < 64; i++) strcat(code, "a1000 a0010 ");
+    if (!Temple_Path(code, grid, 1, 2)) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Cipher strings and add numbers in caller buffers.
+ */
+static u_int8_t checkCipher(void) {
+    char text[] = "abcdef1234";
+    Temple_Caesar(text, 4);
+    if (strcmp(text, "wxyzab7890")) return EXIT_FAILURE;
+
+    char code[] = "abcdefgh1234";
+    if (Temple_Vigenere(code, "ABA") || strcmp(code, "aacddfgg1224")) return EXIT_FAILURE;
+    if (!Temple_Vigenere(code, "")) return EXIT_FAILURE;
+
+    char sum[8];
+    if (Temple_AddNums("999", "1", sum, sizeof(sum)) || strcmp(sum, "1000")) return EXIT_FAILURE;
+    if (!Temple_AddNums("999", "1", sum, 4)) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Count two-grams in caller memory, in order of first occurrence.
+ */
+static u_int8_t checkAgram(void) {
+    static long long mem[1024];
+    TempleAgram *ctx = Temple_AgramInit(mem, sizeof(mem), 2);
+    if (!ctx) return EXIT_FAILURE;
+
+    if (Temple_AgramFeed(ctx, "a b a b,") || Temple_AgramFeed(ctx, "a b\n")) return EXIT_FAILURE;
+    if (Temple_AgramFinish(ctx) || Temple_AgramUnique(ctx) != 2) return EXIT_FAILURE;
+
+    const char *group;
+    u_int64_t frequency;
+    if (Temple_AgramGet(ctx, 0, &group, &frequency) || strcmp(group, "a b") || frequency != 3) return EXIT_FAILURE;
+    if (Temple_AgramGet(ctx, 1, &group, &frequency) || strcmp(group, "b a") || frequency != 2) return EXIT_FAILURE;
+
+    // A third unique two-gram does not fit.
+    ctx = Temple_AgramInit(mem, sizeof(mem), 2);
+    if (!Temple_AgramFeed(ctx, "a b c d")) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Estimate two-grams in caller memory, reporting the frequent ones.
+ */
+static u_int8_t checkSketch(void) {
+    static long long mem[1024];
+    TempleSketch *ctx = Temple_SketchInit(mem, sizeof(mem), 3, 64, 4);
+    if (!ctx) return EXIT_FAILURE;
+
+    // Four unique two-grams for three heavy hitters, "a b" 6 times and "b a" 5 times.
+    if (Temple_SketchFeed(ctx, "a b a b a b,") || Temple_SketchFeed(ctx, "a b a b a b c d\n")) return EXIT_FAILURE;
+    if (Temple_SketchFinish(ctx) || Temple_SketchTotal(ctx) != 13 || Temple_SketchUnique(ctx) != 3) return EXIT_FAILURE;
+
+    const char *group;
+    u_int64_t frequency, error;
+    if (Temple_SketchGet(ctx, 0, &group, &frequency, &error) || strcmp(group, "a b")) return EXIT_FAILURE;
+    if (frequency < 6 || frequency - error > 6) return EXIT_FAILURE;
+    if (Temple_SketchGet(ctx, 1, &group, &frequency, &error) || strcmp(group, "b a")) return EXIT_FAILURE;
+    if (frequency < 5 || frequency - error > 5) return EXIT_FAILURE;
+    if (!Temple_SketchGet(ctx, 3, &group, &frequency, &error)) return EXIT_FAILURE;
+
+    // The memory must hold the whole sketch.
+    if (Temple_SketchInit(mem, sizeof(mem), 3, 4096, 4)) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Count two-grams through the disk with a tiny table, spilling and
+ * merging many runs, and stream them like the exact counter.
+ */
+static u_int8_t checkSpill(void) {
+    static long long mem[16384], exact[2048];
+    if (Temple_SpillCapacity(Temple_SpillSize(2)) != 2) return EXIT_FAILURE;
+
+    TempleSpill *ctx = Temple_SpillInit(mem, sizeof(mem), 2);
+    TempleAgram *agram = Temple_AgramInit(exact, sizeof(exact), 100);
+    if (!ctx || !agram) return EXIT_FAILURE;
+
+    // Forty unique two-grams, two per run: enough runs for a merge by level.
+    char word[16];
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 40; i++) {
+            snprintf(word, sizeof(word), "w%d ", i);
+            if (Temple_SpillFeed(ctx, word) || Temple_AgramFeed(agram, word)) return EXIT_FAILURE;
+        }
+    }
+
+    if (Temple_SpillFinish(ctx) || Temple_AgramFinish(agram)) return EXIT_FAILURE;
+    if (Temple_SpillUnique(ctx) != 40 || Temple_AgramUnique(agram) != 40) return EXIT_FAILURE;
+
+    // Same two-grams, counts and order of first occurrence.
+    const char *group, *expected;
+    u_int64_t frequency, count;
+    u_int8_t status = EXIT_SUCCESS;
+
+    for (int i = 0; i < 40 && !status; i++) {
+        if (Temple_SpillNext(ctx, &group, &frequency) || Temple_AgramGet(agram, i, &expected, &count)
+            || strcmp(group, expected) || frequency != count) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    // The stream ends there, without a disk error.
+    if (!Temple_SpillNext(ctx, &group, &frequency) || Temple_SpillFailed(ctx)) status = EXIT_FAILURE;
+
+    Temple_SpillClose(ctx);
+    return status;
+}
+
+/**
+ * @brief Serve a batch of requests from one arena, reset in O(1) between
+ * requests, and reuse the blocks of a pool.
+ */
+static u_int8_t checkAllocators(void) {
+    static long long region[64];
+    const char *requests[] = { "a7625 a1256", "a1000 a1000", "a0010" };
+
+    TempleArena arena;
+    Temple_ArenaInit(&arena, region, sizeof(region));
+    TempleAllocator allocator = Temple_ArenaAllocator(&arena);
+
+    char *first = NULL;
+    for (int i = 0; i < 3; i++) {
+        // Each request walks its own 3 x 3 temple.
+        char *grid = allocator.alloc(allocator.self, 3 * 3);
+        if (!grid || (first && grid != first)) return EXIT_FAILURE;
+        first = grid;
+
+        // The last request leaves the temple.
+        u_int8_t expected = (i == 2) ? EXIT_FAILURE : EXIT_SUCCESS;
+        if (Temple_Path(requests[i], grid, 3, 3) != expected) return EXIT_FAILURE;
+        allocator.reset(allocator.self);
+        if (arena.used) return EXIT_FAILURE;
+    }
+
+    // An exhausted arena fails instead of overflowing, until reset.
+    if (!allocator.alloc(allocator.self, sizeof(region) - 1)) return EXIT_FAILURE;
+    if (allocator.alloc(allocator.self, 1)) return EXIT_FAILURE;
+    allocator.reset(allocator.self);
+    if (allocator.alloc(allocator.self, sizeof(region)) != (void*)region) return EXIT_FAILURE;
+
+    // A pool of two blocks: free and reuse, exhaustion, oversized requests, reset.
+    TemplePool pool;
+    Temple_PoolInit(&pool, region, 2 * 64, 64);
+    void *a = Temple_PoolAlloc(&pool), *b = Temple_PoolAlloc(&pool);
+    if (!a || !b || a == b || Temple_PoolAlloc(&pool)) return EXIT_FAILURE;
+
+    Temple_PoolFree(&pool, a);
+    if (Temple_PoolAlloc(&pool) != a) return EXIT_FAILURE;
+
+    allocator = Temple_PoolAllocator(&pool);
+    if (allocator.alloc(allocator.self, 65)) return EXIT_FAILURE;
+    allocator.reset(allocator.self);
+    if (allocator.alloc(allocator.self, 64) != a || allocator.alloc(allocator.self, 8) != b) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------SERVICE----------------------------------------------------- */
+
+int main(int argc, char *argv[]) {
+    u_int8_t (*checks[])(void) = { checkPath, checkCipher, checkAgram, checkAllocators, checkSketch, checkSpill };
+    int total = sizeof(checks) / sizeof(checks[0]);
+
+    if (argc != 2) {
+        printf("USAGE: %s <check id>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int checkID = atoi(argv[1]);
+    if (checkID < 0 || checkID >= total) {
+        printf("UNDEFINED CHECK ID...\n");
+        return EXIT_FAILURE;
+    }
+
+    return checks[checkID]();
+}
@@ -25,6 +25,8 @@ function init {
 	mkdir -p output/cipher/vigenere
 	mkdir -p output/cipher/addition
 	mkdir -p output/agram/
+	mkdir -p output/sketch/
+	mkdir -p output/spill/
 }
 
 function print_result {
@@ -124,6 +126,90 @@ function check_task {
 	done
 
 	echo " "
+
+	start_test_id=0
+	end_test_id=5
+	heavy_hitters=64
+
+	printf "${CYAN}%s.........................APPROX TWO GRAMS..........................\n"
+
+	for test_id in $(seq $start_test_id $end_test_id); do
+		test_file="./input/agram/input${test_id}.txt"
+		ref_file="./ref/agram/ref${test_id}.txt"
+		output_file="./output/sketch/output${test_id}.txt"
+
+		# Same text as the exact task, with the size of the heavy hitters table.
+		# The last text is skewed, so that some two-grams exceed total / heavy_hitters.
+		{ echo 4; echo $heavy_hitters; tail -n +2 "$test_file"; } | ./$EXEC > "$output_file"
+
+		if [ -f "$output_file" ]; then
+			# Every estimate must bound the exact count, and every two-gram
+			# more frequent than total / heavy_hitters must be reported.
+			if awk -v k=$heavy_hitters '
+				FNR == 1 { next }
+				{ line = $0; sub(/[ \t]+$/, "", line) }
+				NR == FNR {
+					sub(/[ \t]+[0-9]+$/, "", line)
+					exact[line] = $NF; total += $NF; next
+				}
+				{
+					sub(/[ \t]+[0-9]+[ \t]+[0-9]+$/, "", line); seen[line] = 1
+					count = (line in exact) ? exact[line] : 0
+					if (count > $(NF - 1) || count < $(NF - 1) - $NF) bad = 1
+				}
+				END { for (g in exact) if (exact[g] * k > total && !(g in seen)) bad = 1; exit bad }
+			' "$ref_file" "$output_file" &> /dev/null; then
+				print_result "${test_id}" "passed"
+			else
+				print_result "${test_id}" "failed"
+			fi
+		fi
+		rm -f "$output_file"
+	done
+
+	echo " "
+
+	start_test_id=0
+	end_test_id=4
+	memory_budget=76544
+
+	printf "${CYAN}%s........................EXTERNAL TWO GRAMS.........................\n"
+
+	for test_id in $(seq $start_test_id $end_test_id); do
+		test_file="./input/agram/input${test_id}.txt"
+		ref_file="./ref/agram/ref${test_id}.txt"
+		output_file="./output/spill/output${test_id}.txt"
+
+		# Same text as the exact task, with a budget small enough to spill many runs.
+		{ echo 5; echo $memory_budget; tail -n +2 "$test_file"; } | ./$EXEC > "$output_file"
+
+		if [ -f "$output_file" ]; then
+			if diff -w "$output_file" "$ref_file" &> /dev/null; then
+				print_result "${test_id}" "passed"
+			else
+				print_result "${test_id}" "failed"
+			fi
+		fi
+		rm -f "$output_file"
+	done
+
+	echo " "
+
+	start_test_id=0
+	end_test_id=5
+
+	printf "${CYAN}%s.............................LIBTEMPLE.............................\n"
+
+	for test_id in $(seq $start_test_id $end_test_id); do
+		# In-process consumer, linked against the shared library.
+		if LD_LIBRARY_PATH=. ./service "$test_id" &> /dev/null; then
+			print_result "${test_id}" "passed"
+		else
+			print_result "${test_id}" "failed"
+		fi
+	done
+
+	echo " "
 }
 
 init
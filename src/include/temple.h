@@ -0,0 +1,353 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+/* ---------------------------------------------LIBTEMPLE---------------------------------------------------- */
+
+/**
+ * Public interface of libtemple.
+ *
+ * Every function works on caller owned buffers, keeps no global state and
+ * never allocates, so it is safe to call concurrently on distinct buffers.
+ * The only exception are the run files of TempleSpill, opened with tmpfile.
+ * Status codes follow the rest of the project: EXIT_SUCCESS on success,
+ * EXIT_FAILURE on failure.
+ */
+
+/**
+ * Opaque two-gram counter, placed by Temple_AgramInit into caller memory.
+ */
+typedef struct TempleAgram TempleAgram;
+
+/**
+ * Opaque approximate two-gram counter, a Count-Min sketch and a Space-Saving
+ * heavy hitters table placed by Temple_SketchInit into caller memory.
+ */
+typedef struct TempleSketch TempleSketch;
+
+/**
+ * Opaque external two-gram counter, exact within a memory budget by spilling
+ * sorted runs to the local disk, placed by Temple_SpillInit into caller memory.
+ */
+typedef struct TempleSpill TempleSpill;
+
+/**
+ * Allocator interface, every allocation lives until the next reset.
+ */
+typedef struct TempleAllocator {
+    void*   (*alloc)    (void *self, size_t size);  /* NULL when exhausted */
+    void    (*reset)    (void *self);               /* Release everything, O(1) */
+    void    *self;                                  /* Arena or pool */
+} TempleAllocator;
+
+/**
+ * Bump arena over a caller owned region.
+ */
+typedef struct TempleArena {
+    char *base;             /* Start of the region */
+    size_t size;            /* Size of the region */
+    size_t used;            /* Bytes handed out */
+} TempleArena;
+
+/**
+ * Pool of fixed-size blocks over a caller owned region.
+ */
+typedef struct TemplePool {
+    char *base;             /* Start of the region */
+    size_t block;           /* Aligned size of a block */
+    size_t count;           /* Number of blocks */
+    size_t next;            /* First block never handed out */
+    void *free;             /* Released blocks, linked through their first bytes */
+} TemplePool;
+
+/* ---------------------------------------------LIBTEMPLE---------------------------------------------------- */
+
+/**
+ * @brief Walk the magic temple following a line of magic words.
+ * Each cell holds its step number as a char, so a path has at most 127 cells.
+ *
+ * @param[in]  code The magic words separated by spaces.
+ * @param[out] grid Caller owned N * M row-major grid, cleared and filled with the path.
+ * @param[in]  N    Number of rows.
+ * @param[in]  M    Number of columns.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on a malformed word,
+ *         a path leaving the grid or longer than 127 cells.
+ */
+u_int8_t        Temple_Path         (const char *code, char *grid, int N, int M);
+
+/**
+ * @brief Caesar cipher encryption/decryption, in place.
+ *
+ * @param[in, out] code The string to be encoded/decoded.
+ * @param[in] key       The encryption/decryption key.
+ */
+void            Temple_Caesar       (char *code, int key);
+
+/**
+ * @brief Vigenere cipher encryption/decryption, in place.
+ *
+ * @param[in, out] code The string to be encoded/decoded.
+ * @param[in] key       The encryption/decryption key (upper case letters).
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on a missing string or empty key.
+ */
+u_int8_t        Temple_Vigenere     (char *code, const char *key);
+
+/**
+ * @brief Add two decimal strings, most significant digit first.
+ *
+ * @param[in]  num1 The first number string.
+ * @param[in]  num2 The second number string.
+ * @param[out] sum  Caller buffer receiving the sum, leading zeros are kept.
+ * @param[in]  size Size of 'sum', at least max(strlen(num1), strlen(num2)) + 2.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if 'sum' is too small.
+ */
+u_int8_t        Temple_AddNums      (const char *num1, const char *num2, char *sum, size_t size);
+
+/**
+ * @brief Bytes of memory needed by a two-gram counter.
+ *
+ * @param capacity Maximum number of unique two-grams.
+ * @return Size to pass to Temple_AgramInit, 0 if 'capacity' is invalid.
+ */
+size_t          Temple_AgramSize    (int capacity);
+
+/**
+ * @brief Place an empty two-gram counter into caller memory.
+ *
+ * @param mem      Memory aligned like malloc, of at least Temple_AgramSize(capacity) bytes.
+ * @param size     Size of 'mem'.
+ * @param capacity Maximum number of unique two-grams.
+ * @return The counter, NULL if 'mem' is too small.
+ */
+TempleAgram*    Temple_AgramInit    (void *mem, size_t size, int capacity);
+
+/**
+ * @brief Feed whole words of text, split on " ,.;!\n", into the counter.
+ *
+ * @param ctx  The two-gram counter.
+ * @param text Text to count, a word must not straddle two calls.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the counter is full.
+ */
+u_int8_t        Temple_AgramFeed    (TempleAgram *ctx, const char *text);
+
+/**
+ * @brief Close the text, counting the trailing single word when required.
+ *
+ * @param ctx The two-gram counter.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the counter is full.
+ */
+u_int8_t        Temple_AgramFinish  (TempleAgram *ctx);
+
+/**
+ * @brief Number of unique two-grams counted so far.
+ */
+int             Temple_AgramUnique  (const TempleAgram *ctx);
+
+/**
+ * @brief Read a two-gram, in order of first occurrence.
+ *
+ * @param[in]  ctx       The two-gram counter.
+ * @param[in]  index     Index in [0, Temple_AgramUnique(ctx)).
+ * @param[out] group     The two-gram text, owned by the counter.
+ * @param[out] frequency The two-gram frequency.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if 'index' is out of range.
+ */
+u_int8_t        Temple_AgramGet     (const TempleAgram *ctx, int index,
+                                     const char **group, u_int64_t *frequency);
+
+/**
+ * @brief Bytes of memory needed by an approximate two-gram counter.
+ *
+ * @param capacity Size of the heavy hitters table.
+ * @param width    Counters per row of the Count-Min sketch.
+ * @param depth    Rows of the Count-Min sketch.
+ * @return Size to pass to Temple_SketchInit, 0 if a parameter is invalid.
+ */
+size_t          Temple_SketchSize   (int capacity, int width, int depth);
+
+/**
+ * @brief Place an empty approximate two-gram counter into caller memory.
+ * Its memory stays fixed whatever the volume of text.
+ *
+ * @param mem      Memory aligned like malloc, of at least Temple_SketchSize bytes.
+ * @param size     Size of 'mem'.
+ * @param capacity Size of the heavy hitters table.
+ * @param width    Counters per row of the Count-Min sketch.
+ * @param depth    Rows of the Count-Min sketch.
+ * @return The counter, NULL if 'mem' is too small.
+ */
+TempleSketch*   Temple_SketchInit   (void *mem, size_t size, int capacity, int width, int depth);
+
+/**
+ * @brief Feed whole words of text, split like Temple_AgramFeed.
+ *
+ * @param ctx  The approximate counter.
+ * @param text Text to count, a word must not straddle two calls.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the text is closed.
+ */
+u_int8_t        Temple_SketchFeed   (TempleSketch *ctx, const char *text);
+
+/**
+ * @brief Close the text and rank the heavy hitters, no feeding afterwards.
+ *
+ * @param ctx The approximate counter.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the text was already closed.
+ */
+u_int8_t        Temple_SketchFinish (TempleSketch *ctx);
+
+/**
+ * @brief Number of heavy hitters tracked.
+ */
+int             Temple_SketchUnique (const TempleSketch *ctx);
+
+/**
+ * @brief Number of two-grams counted.
+ */
+u_int64_t       Temple_SketchTotal  (const TempleSketch *ctx);
+
+/**
+ * @brief Read a heavy hitter of a closed text, by decreasing frequency.
+ * Any two-gram more frequent than Temple_SketchTotal / capacity is reported.
+ *
+ * @param[in]  ctx       The approximate counter.
+ * @param[in]  index     Index in [0, Temple_SketchUnique(ctx)).
+ * @param[out] group     The two-gram text, owned by the counter.
+ * @param[out] frequency The estimated frequency, never below the real one.
+ * @param[out] error     Error bound, the real frequency is at least 'frequency - error'.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if 'index' is out of range.
+ */
+u_int8_t        Temple_SketchGet    (const TempleSketch *ctx, int index,
+                                     const char **group, u_int64_t *frequency, u_int64_t *error);
+
+/**
+ * @brief Bytes of memory needed by an external two-gram counter,
+ * buffers of its run files included.
+ *
+ * @param capacity Maximum number of unique two-grams in memory.
+ * @return Size to pass to Temple_SpillInit, 0 if 'capacity' is invalid.
+ */
+size_t          Temple_SpillSize    (int capacity);
+
+/**
+ * @brief Largest in-memory capacity whose Temple_SpillSize fits a budget.
+ *
+ * @param budget Memory budget in bytes.
+ * @return The capacity, 0 if the budget is too small.
+ */
+int             Temple_SpillCapacity (size_t budget);
+
+/**
+ * @brief Place an empty external two-gram counter into caller memory.
+ *
+ * @param mem      Memory aligned like malloc, of at least Temple_SpillSize(capacity) bytes.
+ * @param size     Size of 'mem'.
+ * @param capacity Maximum number of unique two-grams in memory.
+ * @return The counter, NULL if 'mem' is too small.
+ */
+TempleSpill*    Temple_SpillInit    (void *mem, size_t size, int capacity);
+
+/**
+ * @brief Feed whole words of text, split like Temple_AgramFeed.
+ *
+ * @param ctx  The external counter.
+ * @param text Text to count, a word must not straddle two calls.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if a run file cannot be written.
+ */
+u_int8_t        Temple_SpillFeed    (TempleSpill *ctx, const char *text);
+
+/**
+ * @brief Close the text and merge the run files, no feeding afterwards.
+ *
+ * @param ctx The external counter.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on a disk error.
+ */
+u_int8_t        Temple_SpillFinish  (TempleSpill *ctx);
+
+/**
+ * @brief Number of unique two-grams of a closed text.
+ */
+u_int64_t       Temple_SpillUnique  (const TempleSpill *ctx);
+
+/**
+ * @brief Stream the next two-gram of a closed text, in order of first occurrence.
+ *
+ * @param[in]  ctx       The external counter.
+ * @param[out] group     The two-gram text, valid until the next call.
+ * @param[out] frequency The two-gram frequency.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE once every two-gram was read
+ * or on a disk error, told apart by Temple_SpillFailed.
+ */
+u_int8_t        Temple_SpillNext    (TempleSpill *ctx, const char **group, u_int64_t *frequency);
+
+/**
+ * @brief Whether a run file could not be read back, the stream is then incomplete.
+ */
+bool            Temple_SpillFailed  (const TempleSpill *ctx);
+
+/**
+ * @brief Close and remove the run files, the memory stays with the caller.
+ */
+void            Temple_SpillClose   (TempleSpill *ctx);
+
+/* ---------------------------------------------ALLOCATOR---------------------------------------------------- */
+
+/**
+ * @brief Place an empty bump arena over a caller owned region.
+ *
+ * @param arena The arena.
+ * @param mem   The region, aligned like malloc.
+ * @param size  Size of the region.
+ */
+void            Temple_ArenaInit    (TempleArena *arena, void *mem, size_t size);
+
+/**
+ * @brief Allocate from the arena, aligned like malloc.
+ *
+ * @return The memory, NULL if the arena is exhausted.
+ */
+void*           Temple_ArenaAlloc   (TempleArena *arena, size_t size);
+
+/**
+ * @brief Release every allocation of the arena at once.
+ */
+void            Temple_ArenaReset   (TempleArena *arena);
+
+/**
+ * @brief Allocator interface backed by an arena.
+ */
+TempleAllocator Temple_ArenaAllocator (TempleArena *arena);
+
+/**
+ * @brief Split a caller owned region into fixed-size blocks.
+ *
+ * @param pool  The pool.
+ * @param mem   The region, aligned like malloc.
+ * @param size  Size of the region.
+ * @param block Size of a block.
+ */
+void            Temple_PoolInit     (TemplePool *pool, void *mem, size_t size, size_t block);
+
+/**
+ * @brief Allocate one block of the pool.
+ *
+ * @return The block, NULL if the pool is exhausted.
+ */
+void*           Temple_PoolAlloc    (TemplePool *pool);
+
+/**
+ * @brief Give one block back to the pool.
+ */
+void            Temple_PoolFree     (TemplePool *pool, void *ptr);
+
+/**
+ * @brief Release every block of the pool at once.
+ */
+void            Temple_PoolReset    (TemplePool *pool);
+
+/**
+ * @brief Allocator interface backed by a pool, requests larger than a block fail.
+ */
+TempleAllocator Temple_PoolAllocator (TemplePool *pool);
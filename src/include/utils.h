@@ -4,18 +4,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <math.h>
 
+#include "temple.h"
+
 #define         DIRS                4
 #define         DIGITS              10
 #define         BASE10              10
 #define         LETTERS             26
 
 #define         LENGTH              150
+#define         MAX_STEPS           127
 #define         INIT_LEN            15
 
 #define         WORDS               1000
 #define         BUFFER              10000
+#define         ARENA               (1 << 20)
+
+#define         SKETCH_WIDTH        2048
+#define         SKETCH_DEPTH        4
+
+#define         SPILL_RUNS          16
+#define         SPILL_IO            4096
+#define         SPILL_LEVELS        16
 
 #define         ISLOWER(c)          ((c >= 'a') && (c <= 'z'))
 #define         ISDIGIT(c)          ((c >= '0') && (c <= '9'))
@@ -23,7 +35,10 @@
 
 #define         MAX_WORD            32
 #define         MAX_GROUP           64
+#define         SEPARATORS          " ,.;!\n"
 
-u_int8_t        Words               (void);
-u_int8_t        Cipher              (void);
-u_int8_t        Agram               (void);
+u_int8_t        Words               (TempleAllocator *allocator);
+u_int8_t        Cipher              (TempleAllocator *allocator);
+u_int8_t        Agram               (TempleAllocator *allocator);
+u_int8_t        Sketch              (TempleAllocator *allocator);
+u_int8_t        Spill               (TempleAllocator *allocator);
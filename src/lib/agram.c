@@ -3,202 +3,1246 @@
 /* ----------------------------- AGRAM ----------------------------- */
 
 /**
- * Structure to hold information about a paragraph.
+ * Structure to hold information about two-grams.
  */
-typedef struct PARAGRAPH {
-    char text[BUFFER];       /* Paragraph text */
-    char token[MAX_WORD];    /* Token for splitting */
-} Paragraph;
+typedef struct TWOGRAM {
+    char group[MAX_GROUP];  /* Two-gram group */
+    u_int64_t frequency;    /* Frequency count */
+    u_int64_t first;        /* Index of the first occurrence, when spilled */
+} TwoGram;
 
 /**
- * Structure to hold information about words.
+ * Structure to hold a two-gram tracked by the heavy hitters table.
  */
-typedef struct WORD {
-    char word[MAX_WORD];    /* Word text */
-} Word;
+typedef struct HEAVYHITTER {
+    char group[MAX_GROUP];  /* Two-gram group */
+    u_int64_t hash;         /* Hash of the group */
+    u_int64_t count;        /* Space-Saving count, never below the frequency */
+    u_int64_t error;        /* Space-Saving overestimation of the count */
+    u_int64_t estimate;     /* Reported frequency, set when the text is closed */
+    u_int64_t order;        /* Arrival order, breaks ties */
+    int heap;               /* Position in the min-heap */
+} HeavyHitter;
 
 /**
- * Structure to hold information about two-grams.
+ * Structure to hold the words already paired in a text.
  */
-typedef struct TWOGRAM {
-    char group[MAX_GROUP];  /* Two-gram group */
-    int frequency;          /* Frequency count */
-} TwoGram;
+typedef struct PAIRING {
+    u_int64_t total;        /* Number of words seen */
+    bool finished;          /* The text was closed */
+    char last[MAX_WORD];    /* Previous word, waiting for its pair */
+} Pairing;
+
+/**
+ * Structure to hold the state of a two-gram counter.
+ */
+struct TempleAgram {
+    TwoGram *twoGrams;      /* Unique two-grams, in order of first occurrence */
+    int *slots;             /* Hash table of indices in twoGrams, -1 if empty */
+    int capacity;           /* Maximum number of unique two-grams */
+    int mask;               /* Number of slots minus one */
+    int unique;             /* Number of unique two-grams */
+    Pairing pairing;        /* Words of the text */
+};
+
+/**
+ * Structure to hold the state of an approximate two-gram counter.
+ */
+struct TempleSketch {
+    u_int64_t *counters;    /* Count-Min sketch, depth rows of width counters */
+    HeavyHitter *hitters;   /* Space-Saving heavy hitters */
+    int *heap;              /* Min-heap of indices in hitters, by count */
+    int *slots;             /* Hash table of indices in hitters, -1 if empty */
+    int capacity;           /* Size of the heavy hitters table */
+    int width;              /* Counters per row */
+    int depth;              /* Rows of counters */
+    int mask;               /* Number of slots minus one */
+    int unique;             /* Number of tracked two-grams */
+    u_int64_t arrivals;     /* Two-grams entered in the table so far */
+    u_int64_t total;        /* Number of two-grams counted */
+    Pairing pairing;        /* Words of the text */
+};
+
+/**
+ * Structure to hold a run file of sorted two-grams.
+ */
+typedef struct RUN {
+    FILE *file;             /* Unbuffered file, removed once closed */
+    int level;              /* Number of merges the records went through */
+} Run;
+
+/**
+ * Structure to hold a buffered run file, read or written a record at a time.
+ */
+typedef struct CURSOR {
+    FILE *file;             /* The run file */
+    TwoGram *records;       /* Buffer of SPILL_IO bytes */
+    size_t length;          /* Records in the buffer */
+    size_t position;        /* Next record read from the buffer */
+} Cursor;
+
+/**
+ * Structure to hold the state of an external two-gram counter.
+ */
+struct TempleSpill {
+    TempleAgram *table;                     /* In-memory table, spilled when full */
+    Run runs[SPILL_RUNS * SPILL_LEVELS];    /* Run files, by decreasing level */
+    TwoGram *io[SPILL_RUNS + 1];            /* Buffers: merged runs, merge output */
+    Cursor cursors[SPILL_RUNS];             /* Runs being merged */
+    TwoGram heads[SPILL_RUNS];              /* Current record of each merged run */
+    bool live[SPILL_RUNS];                  /* The run still has a current record */
+    TwoGram record;                         /* Last record handed out */
+    int count;                              /* Number of runs */
+    int merging;                            /* Number of runs being merged */
+    u_int64_t pairs;                /* Number of two-grams counted */
+    u_int64_t unique;               /* Number of unique two-grams, once closed */
+    int next;                       /* Next two-gram handed out from the table */
+    bool failed;                    /* A run file could not be read back */
+    Pairing pairing;                /* Words of the text */
+};
+
+/**
+ * Counts one two-gram into a counter.
+ */
+typedef u_int8_t (*CountTwoGram)(void *ctx, const char *group);
+
+/**
+ * Orders two records, like the comparison function of qsort.
+ */
+typedef int (*CompareRecords)(const void *a, const void *b);
 
 /* ----------------------------- AGRAM ----------------------------- */
 
 /**
- * @brief Reads text from the standard input, breaking it into 
- * paragraphs using the specified token.
+ * @brief Number of hash slots for a capacity, a power of two
+ * at least twice as large to keep the probe sequences short.
+ * 
+ * @param capacity Maximum number of unique two-grams.
+ * @return The number of slots.
+ */
+static size_t slotsCount(int capacity) {
+    size_t slots = 1;
+    while (slots < 2 * (size_t)capacity) slots <<= 1;
+    return slots;
+}
+
+/**
+ * @brief FNV-1a hash of a two-gram group.
+ * 
+ * @param group The two-gram group.
+ * @return The hash value.
+ */
+static u_int64_t hashGroup(const char *group) {
+    u_int64_t hash = 14695981039346656037ull;
+
+    for (; *group; group++) {
+        hash ^= (unsigned char)*group;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Swaps two records, byte by byte.
+ */
+static void swapRecords(char *a, char *b, size_t size) {
+    while (size--) {
+        char tmp = *a;
+        *a++ = *b;
+        *b++ = tmp;
+    }
+}
+
+/**
+ * @brief Moves a record down a max-heap of records.
+ * 
+ * @param base    The records.
+ * @param root    The record to move down.
+ * @param count   The number of records in the heap.
+ * @param size    The size of a record.
+ * @param compare Orders two records.
+ */
+static void siftRecords(char *base, size_t root, size_t count, size_t size, CompareRecords compare) {
+    for (;;) {
+        size_t max = root, left = 2 * root + 1, right = 2 * root + 2;
+
+        if (left < count && compare(base + left * size, base + max * size) > 0) max = left;
+        if (right < count && compare(base + right * size, base + max * size) > 0) max = right;
+        if (max == root) return;
+
+        swapRecords(base + root * size, base + max * size, size);
+        root = max;
+    }
+}
+
+/**
+ * @brief Heapsort of records in place. Unlike qsort, which may take a
+ * scratch buffer from malloc, it keeps the counters within their memory.
+ * 
+ * @param records The records.
+ * @param count   The number of records.
+ * @param size    The size of a record.
+ * @param compare Orders two records, never equal for distinct ones.
+ */
+static void sortRecords(void *records, size_t count, size_t size, CompareRecords compare) {
+    char *base = (char*)records;
+
+    for (size_t i = count / 2; i-- > 0; ) siftRecords(base, i, count, size, compare);
+
+    // Move the largest record behind the heap, one at a time.
+    for (size_t end = count; end-- > 1; ) {
+        swapRecords(base, base + end * size, size);
+        siftRecords(base, 0, end, size, compare);
+    }
+}
+
+/**
+ * @brief Tokenizes the text and counts the pairs of consecutive words,
+ * carrying the last word over to the next call.
  * 
- * @param paragraph Pointer to the Paragraph structure.
+ * @param pairing The words of the text.
+ * @param text    The text to count.
+ * @param count   Counts one two-gram.
+ * @param ctx     The counter.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t parseParagraphs(Paragraph *paragraph) {
-    int strT = strlen(paragraph->token);
-    int strP = strlen(paragraph->text);
+static u_int8_t feedPairs(Pairing *pairing, const char *text, CountTwoGram count, void *ctx) {
+    const char *token = SEPARATORS;
 
-    // Check if the combined length of the
-    // paragraph's text and token exceeds the buffer size.
-    if (strP + strT >= BUFFER) {
-        printf("ERROR: Paragraph buffer is too small.\n");
-        return EXIT_FAILURE;
+    if (!text || pairing->finished) return EXIT_FAILURE;
+
+    while (*text) {
+        text += strspn(text, token);
+        int len = strcspn(text, token);
+        if (!len) break;
+
+        // Copy the word, truncated to the word buffer.
+        char word[MAX_WORD];
+        int wordLen = (len < MAX_WORD) ? len : MAX_WORD - 1;
+        memcpy(word, text, wordLen);
+        word[wordLen] = '\0';
+        text += len;
+
+        // Pair the previous word with the current one.
+        if (pairing->total > 0) {
+            char group[MAX_GROUP];
+            snprintf(group, sizeof(group), "%s %s", pairing->last, word);
+
+            if (count(ctx, group)) {
+                return EXIT_FAILURE;
+            }
+        }
+
+        memcpy(pairing->last, word, wordLen + 1);
+        pairing->total++;
     }
 
-    // Read lines from stdin and append them to the paragraph.
-    while (fgets(paragraph->text + strP, BUFFER - strP, stdin)) {
-        char *newline = strchr(paragraph->text + strP, '\n');
-        if (newline) *newline = ' ';
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Closes the text, the last word counts on its own
+ * when the total is divisible by 3 and 5.
+ * 
+ * @param pairing The words of the text.
+ * @param count   Counts one two-gram.
+ * @param ctx     The counter.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t finishPairs(Pairing *pairing, CountTwoGram count, void *ctx) {
+    if (pairing->finished) return EXIT_FAILURE;
+    pairing->finished = true;
 
-        strP += strlen(paragraph->text + strP);
-        snprintf(paragraph->text + strP, BUFFER - strP, " %s", paragraph->token);
-        strP += strlen(paragraph->token) + 1;
+    if (pairing->total > 0 && !(pairing->total % 15)) {
+        return count(ctx, pairing->last);
     }
 
     return EXIT_SUCCESS;
 }
 
 /**
- * @brief Process words by concatenating adjacent words with spaces.
+ * @brief Resets the words of a text.
  * 
- * @param words Pointer to the Word array.
- * @param total Total number of words.
+ * @param pairing The words of the text.
+ */
+static void initPairs(Pairing *pairing) {
+    pairing->total = 0;
+    pairing->finished = false;
+    pairing->last[0] = '\0';
+}
+
+/**
+ * @brief Counts one occurrence of a two-gram, appending it
+ * to the counter on its first occurrence.
+ * 
+ * @param ctx   The two-gram counter.
+ * @param group The two-gram group.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t parseWords(Word *words, int total) {
-    const char space[] = " ";
-    int spaceLen = strlen(space);
+static u_int8_t countTwoGram(void *self, const char *group) {
+    TempleAgram *ctx = (TempleAgram*)self;
+    u_int32_t slot = hashGroup(group) & ctx->mask;
 
-    // Check if any word exceeds the buffer size.
-    for (int i = 0; i < total; i++) {
-        int wordLen = strlen(words[i].word);
+    // Linear probing until the group or an empty slot is found.
+    while (ctx->slots[slot] >= 0) {
+        TwoGram *twoGram = &ctx->twoGrams[ctx->slots[slot]];
 
-        if (wordLen >= MAX_WORD) {
-            printf("ERROR: Word buffer is too small...\n");
-            return EXIT_FAILURE;
+        if (!strcmp(twoGram->group, group)) {
+            twoGram->frequency++;
+            return EXIT_SUCCESS;
         }
+        slot = (slot + 1) & ctx->mask;
+    }
+
+    // Handle the case where the 'twoGrams' array is too small.
+    if (ctx->unique >= ctx->capacity) {
+        return EXIT_FAILURE;
     }
 
-    // Concatenate words and append spaces.
-    for (int i = 0; i < total - 1; i++) {
-        int wordLen1 = strlen(words[i].word);
-        int wordLen2 = strlen(words[i + 1].word);
+    TwoGram *twoGram = &ctx->twoGrams[ctx->unique];
+    strncpy(twoGram->group, group, MAX_GROUP - 1);
+    twoGram->group[MAX_GROUP - 1] = '\0';
+    twoGram->frequency = 1;
+    ctx->slots[slot] = ctx->unique++;
 
-        // Check if appending a space and the next word exceeds the buffer size.
-        if (wordLen1 + spaceLen + wordLen2 >= MAX_WORD) {
-            printf("ERROR: Word buffer is too small...\n");
-            return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Bytes needed by a counter: its state, its two-grams and its slots.
+ * 
+ * @param capacity Maximum number of unique two-grams.
+ * @return The size in bytes, 0 if the capacity is invalid.
+ */
+size_t Temple_AgramSize(int capacity) {
+    if (capacity <= 0) return 0;
+
+    return sizeof(TempleAgram)
+         + (size_t)capacity * sizeof(TwoGram)
+         + slotsCount(capacity) * sizeof(int);
+}
+
+/**
+ * @brief Lays out an empty counter inside the caller memory.
+ * 
+ * @param mem      The caller memory, aligned like malloc.
+ * @param size     The size of the caller memory.
+ * @param capacity Maximum number of unique two-grams.
+ * @return The counter, NULL on failure.
+ */
+TempleAgram* Temple_AgramInit(void *mem, size_t size, int capacity) {
+    size_t need = Temple_AgramSize(capacity);
+    if (!mem || !need || size < need) return NULL;
+
+    // The counter, its two-grams and its slots share the caller memory.
+    TempleAgram *ctx = (TempleAgram*)mem;
+    ctx->twoGrams = (TwoGram*)(ctx + 1);
+    ctx->slots = (int*)(ctx->twoGrams + capacity);
+    ctx->capacity = capacity;
+    ctx->mask = (int)slotsCount(capacity) - 1;
+    ctx->unique = 0;
+    initPairs(&ctx->pairing);
+
+    memset(ctx->slots, -1, (ctx->mask + 1) * sizeof(int));
+    return ctx;
+}
+
+/**
+ * @brief Tokenizes the text and counts the pairs of consecutive words,
+ * carrying the last word over to the next call.
+ * 
+ * @param ctx  The two-gram counter.
+ * @param text The text to count.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_AgramFeed(TempleAgram *ctx, const char *text) {
+    if (!ctx) return EXIT_FAILURE;
+    return feedPairs(&ctx->pairing, text, countTwoGram, ctx);
+}
+
+/**
+ * @brief Closes the text of the counter.
+ * 
+ * @param ctx The two-gram counter.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_AgramFinish(TempleAgram *ctx) {
+    if (!ctx) return EXIT_FAILURE;
+    return finishPairs(&ctx->pairing, countTwoGram, ctx);
+}
+
+/**
+ * @brief Number of unique two-grams of the counter.
+ */
+int Temple_AgramUnique(const TempleAgram *ctx) {
+    return ctx ? ctx->unique : 0;
+}
+
+/**
+ * @brief Reads the two-gram found at a given position.
+ * 
+ * @param[in]  ctx       The two-gram counter.
+ * @param[in]  index     The position, in order of first occurrence.
+ * @param[out] group     The two-gram group.
+ * @param[out] frequency The two-gram frequency.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_AgramGet(const TempleAgram *ctx, int index,
+                         const char **group, u_int64_t *frequency) {
+    if (!ctx || index < 0 || index >= ctx->unique) return EXIT_FAILURE;
+
+    if (group) *group = ctx->twoGrams[index].group;
+    if (frequency) *frequency = ctx->twoGrams[index].frequency;
+
+    return EXIT_SUCCESS;
+}
+
+/* ---------------------------- SKETCH ----------------------------- */
+
+/**
+ * @brief Compares two heavy hitters in the min-heap.
+ * 
+ * @return true if 'a' must sit above 'b'.
+ */
+static bool heapAbove(const TempleSketch *ctx, int a, int b) {
+    const HeavyHitter *x = &ctx->hitters[a], *y = &ctx->hitters[b];
+    return x->count < y->count || (x->count == y->count && x->order < y->order);
+}
+
+/**
+ * @brief Swaps two positions of the min-heap.
+ */
+static void heapSwap(TempleSketch *ctx, int i, int j) {
+    int tmp = ctx->heap[i];
+    ctx->heap[i] = ctx->heap[j];
+    ctx->heap[j] = tmp;
+    ctx->hitters[ctx->heap[i]].heap = i;
+    ctx->hitters[ctx->heap[j]].heap = j;
+}
+
+/**
+ * @brief Moves a heavy hitter up the min-heap.
+ */
+static void heapUp(TempleSketch *ctx, int i) {
+    while (i > 0 && heapAbove(ctx, ctx->heap[i], ctx->heap[(i - 1) / 2])) {
+        heapSwap(ctx, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+/**
+ * @brief Moves a heavy hitter down the min-heap, after its count grew.
+ */
+static void heapDown(TempleSketch *ctx, int i) {
+    for (;;) {
+        int min = i, left = 2 * i + 1, right = 2 * i + 2;
+
+        if (left < ctx->unique && heapAbove(ctx, ctx->heap[left], ctx->heap[min])) min = left;
+        if (right < ctx->unique && heapAbove(ctx, ctx->heap[right], ctx->heap[min])) min = right;
+        if (min == i) return;
+
+        heapSwap(ctx, i, min);
+        i = min;
+    }
+}
+
+/**
+ * @brief Removes a heavy hitter from the hash table, shifting back
+ * the following entries so that no probe sequence is broken.
+ * 
+ * @param ctx   The approximate counter.
+ * @param index The heavy hitter to remove.
+ */
+static void removeSlot(TempleSketch *ctx, int index) {
+    u_int32_t hole = ctx->hitters[index].hash & ctx->mask;
+    while (ctx->slots[hole] != index) hole = (hole + 1) & ctx->mask;
+
+    ctx->slots[hole] = -1;
+
+    for (u_int32_t next = (hole + 1) & ctx->mask; ctx->slots[next] >= 0; next = (next + 1) & ctx->mask) {
+        u_int32_t home = ctx->hitters[ctx->slots[next]].hash & ctx->mask;
+
+        // Move the entry into the hole unless its home lies between the two.
+        if (((next - home) & ctx->mask) >= ((next - hole) & ctx->mask)) {
+            ctx->slots[hole] = ctx->slots[next];
+            ctx->slots[next] = -1;
+            hole = next;
         }
+    }
+}
+
+/**
+ * @brief Count-Min estimate of a two-gram, never below its frequency.
+ * 
+ * @param ctx  The approximate counter.
+ * @param hash The hash of the two-gram.
+ * @return The estimate.
+ */
+static u_int64_t sketchEstimate(const TempleSketch *ctx, u_int64_t hash) {
+    u_int32_t h1 = (u_int32_t)hash, h2 = (u_int32_t)(hash >> 32) | 1;
+    u_int64_t min = UINT64_MAX;
+
+    for (int row = 0; row < ctx->depth; row++) {
+        u_int64_t counter = ctx->counters[(size_t)row * ctx->width + (h1 + row * h2) % ctx->width];
+        if (counter < min) min = counter;
+    }
 
-        // Append a space and the next word.
-        snprintf(words[i].word + wordLen1, MAX_WORD - wordLen1, " %s", words[i + 1].word);
-        // Append a space at the end of the current word.
-        strncat(words[i].word, space, MAX_WORD - wordLen1 - 1);
+    return min;
+}
+
+/**
+ * @brief Counts one occurrence of a two-gram in the Count-Min sketch
+ * and in the Space-Saving table, evicting the smallest heavy hitter
+ * when the table is full.
+ * 
+ * @param self  The approximate counter.
+ * @param group The two-gram group.
+ * @return EXIT_SUCCESS.
+ */
+static u_int8_t countSketch(void *self, const char *group) {
+    TempleSketch *ctx = (TempleSketch*)self;
+    u_int64_t hash = hashGroup(group);
+    u_int32_t h1 = (u_int32_t)hash, h2 = (u_int32_t)(hash >> 32) | 1;
+
+    // Update one counter per row, double hashing picks the columns.
+    for (int row = 0; row < ctx->depth; row++) {
+        ctx->counters[(size_t)row * ctx->width + (h1 + row * h2) % ctx->width]++;
     }
+    ctx->total++;
+
+    // Linear probing until the group or an empty slot is found.
+    u_int32_t slot = hash & ctx->mask;
+    while (ctx->slots[slot] >= 0) {
+        HeavyHitter *hitter = &ctx->hitters[ctx->slots[slot]];
+
+        if (hitter->hash == hash && !strcmp(hitter->group, group)) {
+            hitter->count++;
+            heapDown(ctx, hitter->heap);
+            return EXIT_SUCCESS;
+        }
+        slot = (slot + 1) & ctx->mask;
+    }
+
+    int index;
+    u_int64_t count = 0;
+
+    if (ctx->unique < ctx->capacity) {
+        // Room left, track the two-gram exactly from now on.
+        index = ctx->unique;
+        ctx->heap[ctx->unique] = index;
+        ctx->hitters[index].heap = ctx->unique++;
+    } else {
+        // Table full, the two-gram replaces the smallest heavy hitter.
+        index = ctx->heap[0];
+        count = ctx->hitters[index].count;
+        removeSlot(ctx, index);
+
+        // The removal may have shifted the empty slot of the group.
+        slot = hash & ctx->mask;
+        while (ctx->slots[slot] >= 0) slot = (slot + 1) & ctx->mask;
+    }
+
+    HeavyHitter *hitter = &ctx->hitters[index];
+    strncpy(hitter->group, group, MAX_GROUP - 1);
+    hitter->group[MAX_GROUP - 1] = '\0';
+    hitter->hash = hash;
+    hitter->count = count + 1;
+    hitter->error = count;
+    hitter->order = ctx->arrivals++;
+    ctx->slots[slot] = index;
+
+    if (count) heapDown(ctx, hitter->heap);
+    else heapUp(ctx, hitter->heap);
 
     return EXIT_SUCCESS;
 }
 
 /**
- * @brief Calculates the frequency of two-grams from an array of words and stores
- * the results in the provided TwoGram array. Two-grams are pairs of consecutive words.
+ * @brief Orders the heavy hitters by estimate, then by arrival.
+ */
+static int compareHitters(const void *a, const void *b) {
+    const HeavyHitter *x = (const HeavyHitter*)a, *y = (const HeavyHitter*)b;
+
+    if (x->estimate != y->estimate) return (x->estimate < y->estimate) ? 1 : -1;
+    return (x->order > y->order) - (x->order < y->order);
+}
+
+/**
+ * @brief Bytes needed by an approximate counter: its state, its heavy hitters,
+ * its heap, its slots and its Count-Min counters.
  * 
- * @param words    Pointer to the Word array containing the words.
- * @param total    Total number of words in the array.
- * @param twoGrams Pointer to the TwoGram array to store the two-gram results.
+ * @param capacity Size of the heavy hitters table.
+ * @param width    Counters per row of the sketch.
+ * @param depth    Rows of the sketch.
+ * @return The size in bytes, 0 if a parameter is invalid.
+ */
+size_t Temple_SketchSize(int capacity, int width, int depth) {
+    if (capacity <= 0 || width <= 0 || depth <= 0) return 0;
+
+    return sizeof(TempleSketch)
+         + (size_t)capacity * sizeof(HeavyHitter)
+         + (size_t)width * depth * sizeof(u_int64_t)
+         + (size_t)capacity * sizeof(int)
+         + slotsCount(capacity) * sizeof(int);
+}
+
+/**
+ * @brief Lays out an empty approximate counter inside the caller memory.
+ * 
+ * @param mem      The caller memory, aligned like malloc.
+ * @param size     The size of the caller memory.
+ * @param capacity Size of the heavy hitters table.
+ * @param width    Counters per row of the sketch.
+ * @param depth    Rows of the sketch.
+ * @return The approximate counter, NULL on failure.
+ */
+TempleSketch* Temple_SketchInit(void *mem, size_t size, int capacity, int width, int depth) {
+    size_t need = Temple_SketchSize(capacity, width, depth);
+    if (!mem || !need || size < need) return NULL;
+
+    // The counter, its heavy hitters, counters, heap and slots share the caller memory.
+    TempleSketch *ctx = (TempleSketch*)mem;
+    ctx->hitters = (HeavyHitter*)(ctx + 1);
+    ctx->counters = (u_int64_t*)(ctx->hitters + capacity);
+    ctx->heap = (int*)(ctx->counters + (size_t)width * depth);
+    ctx->slots = ctx->heap + capacity;
+    ctx->capacity = capacity;
+    ctx->width = width;
+    ctx->depth = depth;
+    ctx->mask = (int)slotsCount(capacity) - 1;
+    ctx->unique = 0;
+    ctx->arrivals = 0;
+    ctx->total = 0;
+    initPairs(&ctx->pairing);
+
+    memset(ctx->counters, 0, (size_t)width * depth * sizeof(u_int64_t));
+    memset(ctx->slots, -1, (ctx->mask + 1) * sizeof(int));
+    return ctx;
+}
+
+/**
+ * @brief Tokenizes the text and counts the pairs of consecutive words.
+ * 
+ * @param ctx  The approximate counter.
+ * @param text The text to count.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t findTwoGrams(Word *words, int total, TwoGram *twoGrams) {
-    // Calculate frequencies of two-grams.
-    for (int i = 0; i < total; i++) {
-        int len = strlen(words[i].word);
+u_int8_t Temple_SketchFeed(TempleSketch *ctx, const char *text) {
+    if (!ctx) return EXIT_FAILURE;
+    return feedPairs(&ctx->pairing, text, countSketch, ctx);
+}
 
-        if (len >= MAX_GROUP) {
-            printf("Error: Buffer too small to store the group...\n");
-            return EXIT_FAILURE;
+/**
+ * @brief Closes the text and sorts the heavy hitters by estimate,
+ * the smaller of the Space-Saving count and the Count-Min estimate.
+ * 
+ * @param ctx The approximate counter.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_SketchFinish(TempleSketch *ctx) {
+    if (!ctx || finishPairs(&ctx->pairing, countSketch, ctx)) return EXIT_FAILURE;
+
+    for (int i = 0; i < ctx->unique; i++) {
+        HeavyHitter *hitter = &ctx->hitters[i];
+        u_int64_t estimate = sketchEstimate(ctx, hitter->hash);
+
+        hitter->estimate = (hitter->count < estimate) ? hitter->count : estimate;
+    }
+
+    // The heap and the slots are no longer needed once the text is closed.
+    sortRecords(ctx->hitters, ctx->unique, sizeof(HeavyHitter), compareHitters);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Number of heavy hitters of the approximate counter.
+ */
+int Temple_SketchUnique(const TempleSketch *ctx) {
+    return ctx ? ctx->unique : 0;
+}
+
+/**
+ * @brief Number of two-grams counted by the approximate counter.
+ */
+u_int64_t Temple_SketchTotal(const TempleSketch *ctx) {
+    return ctx ? ctx->total : 0;
+}
+
+/**
+ * @brief Reads the heavy hitter found at a given position.
+ * 
+ * @param[in]  ctx       The approximate counter.
+ * @param[in]  index     The position, by decreasing estimate.
+ * @param[out] group     The two-gram group.
+ * @param[out] frequency The estimated frequency, never below the real one.
+ * @param[out] error     The real frequency is at least 'frequency - error'.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_SketchGet(const TempleSketch *ctx, int index,
+                          const char **group, u_int64_t *frequency, u_int64_t *error) {
+    if (!ctx || !ctx->pairing.finished || index < 0 || index >= ctx->unique) return EXIT_FAILURE;
+
+    const HeavyHitter *hitter = &ctx->hitters[index];
+    if (group) *group = hitter->group;
+    if (frequency) *frequency = hitter->estimate;
+    if (error) *error = hitter->estimate - (hitter->count - hitter->error);
+
+    return EXIT_SUCCESS;
+}
+
+/* ---------------------------- SKETCH ----------------------------- */
+
+/* ---------------------------- SPILL ------------------------------ */
+
+/**
+ * @brief Orders spilled two-grams by group.
+ */
+static int compareGroups(const void *a, const void *b) {
+    return strcmp(((const TwoGram*)a)->group, ((const TwoGram*)b)->group);
+}
+
+/**
+ * @brief Orders spilled two-grams by first occurrence.
+ */
+static int compareFirst(const void *a, const void *b) {
+    const TwoGram *x = (const TwoGram*)a, *y = (const TwoGram*)b;
+    return (x->first > y->first) - (x->first < y->first);
+}
+
+/**
+ * @brief Creates an empty run file on the local disk, removed once closed.
+ * Runs are buffered by hand, so that only the merged ones need a buffer.
+ * 
+ * @return The run file, NULL on failure.
+ */
+static FILE* openRun(void) {
+    FILE *run = tmpfile();
+    if (run && setvbuf(run, NULL, _IONBF, 0)) {
+        fclose(run);
+        return NULL;
+    }
+    return run;
+}
+
+/**
+ * @brief Closes the run files of the external counter, from a given one.
+ * 
+ * @param ctx  The external counter.
+ * @param from The first run closed.
+ */
+static void closeRuns(TempleSpill *ctx, int from) {
+    for (int i = from; i < ctx->count; i++) {
+        fclose(ctx->runs[i].file);
+    }
+    ctx->count = from;
+}
+
+/**
+ * @brief Attaches a buffer to a run file, from its start.
+ * 
+ * @param cursor The cursor over the run.
+ * @param file   The run file.
+ * @param buffer The buffer, of SPILL_IO bytes.
+ */
+static void openCursor(Cursor *cursor, FILE *file, TwoGram *buffer) {
+    rewind(file);
+    cursor->file = file;
+    cursor->records = buffer;
+    cursor->length = 0;
+    cursor->position = 0;
+}
+
+/**
+ * @brief Reads the next record of a run, refilling the buffer when empty.
+ * 
+ * @param ctx    The external counter.
+ * @param cursor The cursor over the run.
+ * @param record The record read.
+ * @return true if a record was read, false at the end of the run.
+ */
+static bool readRecord(TempleSpill *ctx, Cursor *cursor, TwoGram *record) {
+    if (cursor->position == cursor->length) {
+        cursor->length = fread(cursor->records, sizeof(TwoGram), SPILL_IO / sizeof(TwoGram), cursor->file);
+        cursor->position = 0;
+
+        if (ferror(cursor->file)) ctx->failed = true;
+        if (!cursor->length) return false;
+    }
+
+    *record = cursor->records[cursor->position++];
+    return true;
+}
+
+/**
+ * @brief Writes the buffered records of a run.
+ * 
+ * @param cursor The cursor over the run.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t flushRecords(Cursor *cursor) {
+    size_t length = cursor->length;
+    cursor->length = 0;
+
+    return fwrite(cursor->records, sizeof(TwoGram), length, cursor->file) == length
+            ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Appends a record to a run, writing the buffer once full.
+ * 
+ * @param cursor The cursor over the run.
+ * @param record The record written.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t writeRecord(Cursor *cursor, const TwoGram *record) {
+    cursor->records[cursor->length++] = *record;
+    return cursor->length == SPILL_IO / sizeof(TwoGram) ? flushRecords(cursor) : EXIT_SUCCESS;
+}
+
+/**
+ * @brief Reads the first record of a merged run.
+ * 
+ * @param ctx The external counter.
+ * @param run The merged run to advance.
+ */
+static void advanceRun(TempleSpill *ctx, int run) {
+    ctx->live[run] = readRecord(ctx, &ctx->cursors[run], &ctx->heads[run]);
+}
+
+/**
+ * @brief Rewinds the last runs, at most SPILL_RUNS, and reads their first record.
+ * 
+ * @param ctx  The external counter.
+ * @param from The first run merged.
+ */
+static void startMerge(TempleSpill *ctx, int from) {
+    ctx->merging = ctx->count - from;
+
+    for (int i = 0; i < ctx->merging; i++) {
+        openCursor(&ctx->cursors[i], ctx->runs[from + i].file, ctx->io[i]);
+        advanceRun(ctx, i);
+    }
+}
+
+/**
+ * @brief One step of the k-way merge of the runs. By group, the records
+ * of the same two-gram are combined, keeping its earliest occurrence.
+ * 
+ * @param ctx     The external counter.
+ * @param byGroup The runs are sorted by group, else by first occurrence.
+ * @param record  The merged record.
+ * @return true if a record was merged, false once every run is exhausted.
+ */
+static bool nextRecord(TempleSpill *ctx, bool byGroup, TwoGram *record) {
+    int min = -1;
+
+    // Pick the smallest current record.
+    for (int i = 0; i < ctx->merging; i++) {
+        if (!ctx->live[i]) continue;
+
+        if (min < 0 || (byGroup ? strcmp(ctx->heads[i].group, ctx->heads[min].group) < 0
+                                : ctx->heads[i].first < ctx->heads[min].first)) {
+            min = i;
         }
+    }
 
-        // Copy the current word as the group for the two-gram.
-        strncpy(twoGrams[i].group, words[i].word, MAX_GROUP - 1);
-        twoGrams[i].group[MAX_GROUP - 1] = '\0';
-        twoGrams[i].frequency = 1;
+    if (min < 0) return false;
 
-        // Count the frequency of the two-gram by comparing with subsequent words.
-        for (int j = i + 1; j < total; j++) {
-            if (!strcmp(words[i].word, words[j].word)) {
-                twoGrams[i].frequency++;
-            }
+    *record = ctx->heads[min];
+    advanceRun(ctx, min);
+
+    // A run holds a group at most once, combine it from the other runs.
+    for (int i = 0; byGroup && i < ctx->merging; i++) {
+        if (ctx->live[i] && !strcmp(ctx->heads[i].group, record->group)) {
+            record->frequency += ctx->heads[i].frequency;
+            if (ctx->heads[i].first < record->first) record->first = ctx->heads[i].first;
+            advanceRun(ctx, i);
         }
     }
 
-    // Eliminate duplicate two-grams in the array.
-    for (int i = 0; i < total; i++) {
-        for (int j = i + 1; j < total; j++) {
-            if (!strcmp(twoGrams[i].group, twoGrams[j].group)) {
-                twoGrams[j].frequency = 0;
-            }
+    return true;
+}
+
+/**
+ * @brief Merges the last runs into a single one, a level above the highest.
+ * 
+ * @param ctx     The external counter.
+ * @param from    The first run merged, at most SPILL_RUNS before the last.
+ * @param byGroup The runs are sorted by group, else by first occurrence.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t mergeRuns(TempleSpill *ctx, int from, bool byGroup) {
+    FILE *merged = openRun();
+    if (!merged) return EXIT_FAILURE;
+
+    // Runs are kept by decreasing level, the first one is the highest.
+    int level = ctx->runs[from].level + 1;
+    u_int8_t status = EXIT_SUCCESS;
+    Cursor output;
+    TwoGram record;
+
+    openCursor(&output, merged, ctx->io[SPILL_RUNS]);
+    startMerge(ctx, from);
+
+    while (!status && nextRecord(ctx, byGroup, &record)) {
+        status = writeRecord(&output, &record);
+    }
+
+    if (!status) status = flushRecords(&output);
+
+    closeRuns(ctx, from);
+    if (status || ctx->failed) {
+        fclose(merged);
+        return EXIT_FAILURE;
+    }
+
+    ctx->runs[ctx->count++] = (Run){ merged, level };
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Merges the last runs until at most SPILL_RUNS are left,
+ * so that they can all be merged at once.
+ * 
+ * @param ctx     The external counter.
+ * @param byGroup The runs are sorted by group, else by first occurrence.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t reduceRuns(TempleSpill *ctx, bool byGroup) {
+    while (ctx->count > SPILL_RUNS) {
+        // Merge the fewest, smallest runs that bring the count down.
+        int merged = ctx->count - SPILL_RUNS + 1;
+        if (merged > SPILL_RUNS) merged = SPILL_RUNS;
+
+        if (mergeRuns(ctx, ctx->count - merged, byGroup)) return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Sorts records and writes them as a new run. Runs are merged by
+ * level: SPILL_RUNS runs of the same level become one run of the next
+ * level, so a record is rewritten once per level, log(runs) times.
+ * 
+ * @param ctx     The external counter.
+ * @param records The records to write.
+ * @param total   The number of records.
+ * @param byGroup Sort by group, else by first occurrence.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t writeRun(TempleSpill *ctx, TwoGram *records, int total, bool byGroup) {
+    if (ctx->count == SPILL_RUNS * SPILL_LEVELS) return EXIT_FAILURE;
+
+    sortRecords(records, total, sizeof(TwoGram), byGroup ? compareGroups : compareFirst);
+
+    FILE *run = openRun();
+    if (!run) return EXIT_FAILURE;
+
+    if ((int)fwrite(records, sizeof(TwoGram), total, run) != total) {
+        fclose(run);
+        return EXIT_FAILURE;
+    }
+
+    ctx->runs[ctx->count++] = (Run){ run, 0 };
+
+    // Merge the last SPILL_RUNS runs while they share a level.
+    while (ctx->count >= SPILL_RUNS) {
+        int from = ctx->count - SPILL_RUNS;
+        if (ctx->runs[from].level != ctx->runs[ctx->count - 1].level) break;
+
+        if (mergeRuns(ctx, from, byGroup)) return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Counts one occurrence of a two-gram in the in-memory table,
+ * spilling the table as a run sorted by group when it is full.
+ * 
+ * @param self  The external counter.
+ * @param group The two-gram group.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static u_int8_t countSpill(void *self, const char *group) {
+    TempleSpill *ctx = (TempleSpill*)self;
+    TempleAgram *table = ctx->table;
+    int unique = table->unique;
+
+    if (countTwoGram(table, group)) {
+        if (writeRun(ctx, table->twoGrams, unique, true)) {
+            return EXIT_FAILURE;
         }
+
+        // Start over with an empty table.
+        Temple_AgramInit(table, Temple_AgramSize(table->capacity), table->capacity);
+        unique = 0;
+        countTwoGram(table, group);
     }
 
+    // Remember where a new two-gram first occurred.
+    if (table->unique > unique) table->twoGrams[unique].first = ctx->pairs;
+    ctx->pairs++;
+
     return EXIT_SUCCESS;
 }
 
 /**
- * @brief Tokenizes a given paragraph's text using the specified token
- * and stores the resulting words in the provided Word array. The total number
- * of words found is stored in the 'total' parameter.
+ * @brief Bytes needed by an external counter: its state, its run
+ * buffers and its in-memory table.
+ * 
+ * @param capacity Maximum number of unique two-grams in memory.
+ * @return The size in bytes, 0 if the capacity is invalid.
+ */
+size_t Temple_SpillSize(int capacity) {
+    size_t table = Temple_AgramSize(capacity);
+    if (!table) return 0;
+
+    return sizeof(TempleSpill) + (SPILL_RUNS + 1) * (size_t)SPILL_IO + table;
+}
+
+/**
+ * @brief Largest in-memory table fitting in a memory budget.
+ * 
+ * @param budget The memory budget in bytes.
+ * @return The capacity, 0 if the budget is too small.
+ */
+int Temple_SpillCapacity(size_t budget) {
+    int low = 0, high = WORDS;
+
+    // Grow the upper bound until it no longer fits.
+    while (high < INT32_MAX / 2 && Temple_SpillSize(high) <= budget) {
+        low = high;
+        high *= 2;
+    }
+
+    // Binary search between the last size fitting and the first one not.
+    while (high - low > 1) {
+        int mid = low + (high - low) / 2;
+        if (Temple_SpillSize(mid) <= budget) low = mid;
+        else high = mid;
+    }
+
+    return (low > 0 && Temple_SpillSize(low) <= budget) ? low : 0;
+}
+
+/**
+ * @brief Lays out an empty external counter inside the caller memory.
+ * 
+ * @param mem      The caller memory, aligned like malloc.
+ * @param size     The size of the caller memory.
+ * @param capacity Maximum number of unique two-grams in memory.
+ * @return The external counter, NULL on failure.
+ */
+TempleSpill* Temple_SpillInit(void *mem, size_t size, int capacity) {
+    size_t need = Temple_SpillSize(capacity);
+    if (!mem || !need || size < need) return NULL;
+
+    // The counter, its buffers and its table share the caller memory.
+    TempleSpill *ctx = (TempleSpill*)mem;
+    char *buffers = (char*)(ctx + 1);
+
+    for (int i = 0; i < SPILL_RUNS + 1; i++) {
+        ctx->io[i] = (TwoGram*)(buffers + (size_t)i * SPILL_IO);
+    }
+
+    ctx->table = Temple_AgramInit(buffers + (SPILL_RUNS + 1) * (size_t)SPILL_IO,
+                                  Temple_AgramSize(capacity), capacity);
+    ctx->count = 0;
+    ctx->merging = 0;
+    ctx->pairs = 0;
+    ctx->unique = 0;
+    ctx->next = 0;
+    ctx->failed = false;
+    initPairs(&ctx->pairing);
+
+    return ctx;
+}
+
+/**
+ * @brief Tokenizes the text and counts the pairs of consecutive words.
+ * 
+ * @param ctx  The external counter.
+ * @param text The text to count.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_SpillFeed(TempleSpill *ctx, const char *text) {
+    if (!ctx) return EXIT_FAILURE;
+    return feedPairs(&ctx->pairing, text, countSpill, ctx);
+}
+
+/**
+ * @brief Closes the text. Once spilled, the runs are merged by group into
+ * exact counts, then sorted again by first occurrence into new runs.
  * 
- * @param paragraph Pointer to the Paragraph structure containing the text to tokenize.
- * @param words Pointer to the Word array to store the tokenized words.
- * @param total Pointer to an integer to store the total number of words found.
+ * @param ctx The external counter.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t tokenizeWords(Paragraph *paragraph, Word *words, int *total) {
-    char *token = strtok(paragraph->text, paragraph->token);
+u_int8_t Temple_SpillFinish(TempleSpill *ctx) {
+    if (!ctx || finishPairs(&ctx->pairing, countSpill, ctx)) return EXIT_FAILURE;
+
+    TempleAgram *table = ctx->table;
+
+    // Never spilled, the table already holds the two-grams in order.
+    if (!ctx->count) {
+        ctx->unique = table->unique;
+        return EXIT_SUCCESS;
+    }
+
+    // Spill the rest of the table and merge every run into exact counts.
+    if (writeRun(ctx, table->twoGrams, table->unique, true) || reduceRuns(ctx, true)
+        || mergeRuns(ctx, 0, true)) {
+        return EXIT_FAILURE;
+    }
+
+    // Set the merged run apart, it is read straight into the table.
+    FILE *merged = ctx->runs[0].file;
+    ctx->count = 0;
+    rewind(merged);
+
+    // Sort the exact counts by first occurrence, one table at a time.
+    size_t total;
+    while ((total = fread(table->twoGrams, sizeof(TwoGram), table->capacity, merged)) > 0) {
+        ctx->unique += total;
 
-    while (token) {
-        // Handle the case where the 'words' array is too small.
-        if (*total >= WORDS) {
-            printf("ERROR: Words array is too small.\n");
+        if (writeRun(ctx, table->twoGrams, total, false)) {
+            fclose(merged);
             return EXIT_FAILURE;
         }
+    }
+
+    bool failed = ferror(merged);
+    fclose(merged);
+    if (failed || reduceRuns(ctx, false)) return EXIT_FAILURE;
+
+    startMerge(ctx, 0);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Number of unique two-grams of a closed text.
+ */
+u_int64_t Temple_SpillUnique(const TempleSpill *ctx) {
+    return ctx ? ctx->unique : 0;
+}
+
+/**
+ * @brief Streams the next two-gram, in order of first occurrence.
+ * 
+ * @param[in]  ctx       The external counter.
+ * @param[out] group     The two-gram group.
+ * @param[out] frequency The two-gram frequency.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE once every two-gram was read
+ * or on a disk error.
+ */
+u_int8_t Temple_SpillNext(TempleSpill *ctx, const char **group, u_int64_t *frequency) {
+    if (!ctx || !ctx->pairing.finished || ctx->failed) return EXIT_FAILURE;
 
-        // Copy the tokenized word into the Word array.
-        strncpy(words[*total].word, token, MAX_WORD - 1);
-        words[*total].word[MAX_WORD - 1] = '\0'; // Ensure null-termination.
-        (*total)++;
-        token = strtok(NULL, paragraph->token);
+    if (!ctx->count) {
+        // Read straight from the table.
+        if (ctx->next >= ctx->table->unique) return EXIT_FAILURE;
+        ctx->record = ctx->table->twoGrams[ctx->next++];
+    } else if (!nextRecord(ctx, false, &ctx->record)) {
+        return EXIT_FAILURE;
     }
 
+    if (group) *group = ctx->record.group;
+    if (frequency) *frequency = ctx->record.frequency;
+
     return EXIT_SUCCESS;
 }
 
 /**
- *
- * @brief Counts the number of unique two-grams and prints the count
- * along with each unique two-gram and its frequency.
+ * @brief Whether a run file could not be read back.
+ */
+bool Temple_SpillFailed(const TempleSpill *ctx) {
+    return ctx ? ctx->failed : false;
+}
+
+/**
+ * @brief Closes the run files of the external counter.
+ * 
+ * @param ctx The external counter.
+ */
+void Temple_SpillClose(TempleSpill *ctx) {
+    if (ctx) closeRuns(ctx, 0);
+}
+
+/* ---------------------------- SPILL ------------------------------ */
+
+/**
+ * @brief Reads text from the standard input, line by line,
+ * and feeds it into a two-gram counter.
  * 
- * @param twoGrams Pointer to the TwoGram array.
- * @param total Total number of two-grams.
+ * @param pairing The words of the text.
+ * @param count   Counts one two-gram.
+ * @param ctx     The counter.
+ * @param line    The line buffer, of BUFFER bytes.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static void outputTwoGrams(TwoGram *twoGrams, int total) {
-    int uniqueTwoGrams = 0;
+static u_int8_t parseParagraphs(Pairing *pairing, CountTwoGram count, void *ctx, char *line) {
+    size_t carried = 0;
 
-    // Count the number of unique two-grams.
-    for (int i = 0; i < total; i++) {
-        if (twoGrams[i].frequency > 0) {
-            uniqueTwoGrams++;
+    while (fgets(line + carried, BUFFER - carried, stdin)) {
+        size_t length = carried + strlen(line + carried), start = length;
+        carried = 0;
+
+        // A longer line is read in pieces, its unfinished last word is
+        // carried over to the next read. A word filling the whole buffer is cut.
+        if (line[length - 1] != '\n' && !feof(stdin)) {
+            size_t cut = length;
+            while (cut > 0 && !strchr(SEPARATORS, line[cut - 1])) cut--;
+
+            if (cut > 0) {
+                start = cut;
+                carried = length - cut;
+            }
         }
+
+        char first = line[start];
+        line[start] = '\0';
+
+        if (feedPairs(pairing, line, count, ctx)) {
+            printf("ERROR: TwoGrams array is too small.\n");
+            return EXIT_FAILURE;
+        }
+
+        line[start] = first;
+        memmove(line, line + start, carried);
     }
 
+    // The text may end right after a carried word.
+    line[carried] = '\0';
+    if (carried && feedPairs(pairing, line, count, ctx)) {
+        printf("ERROR: TwoGrams array is too small.\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ *
+ * @brief Prints the count of unique two-grams
+ * along with each unique two-gram and its frequency.
+ * 
+ * @param ctx The two-gram counter.
+ */
+static void outputTwoGrams(const TempleAgram *ctx) {
+    int uniqueTwoGrams = Temple_AgramUnique(ctx);
+
     // Print the total number of unique two-grams.
     printf("%d\n", uniqueTwoGrams);
 
     // Print each unique two-gram and its frequency.
-    for (int i = 0; i < total; i++) {
-        if (twoGrams[i].frequency > 0) {
-            printf("%s %d\n", twoGrams[i].group, twoGrams[i].frequency);
-        }
+    for (int i = 0; i < uniqueTwoGrams; i++) {
+        const char *group;
+        u_int64_t frequency;
+
+        Temple_AgramGet(ctx, i, &group, &frequency);
+        printf("%s %llu\n", group, (unsigned long long)frequency);
     }
 }
 
@@ -206,43 +1250,168 @@ static void outputTwoGrams(TwoGram *twoGrams, int total) {
  * @brief Main function for Agram.
  * Reads a command and invokes the corresponding handler function.
  * 
+ * @param allocator The allocator of the counter and the line buffer.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-u_int8_t Agram(void) {
-    Paragraph paragraph;
-    strcpy(paragraph.token, " ,.;!\n");
-    memset(paragraph.text, 0, sizeof(paragraph.text));
+u_int8_t Agram(TempleAllocator *allocator) {
+    size_t size = Temple_AgramSize(WORDS);
+    void *mem = allocator->alloc(allocator->self, size);
+    char *line = allocator->alloc(allocator->self, BUFFER);
 
-    if (parseParagraphs(&paragraph)) {
+    TempleAgram *ctx = Temple_AgramInit(mem, size, WORDS);
+    if (!ctx || !line) {
+        printf("ERROR: Arena is too small.\n");
         return EXIT_FAILURE;
     }
 
-    Word words[WORDS];
-    int total = 0; // Total number of words.
+    // Find and count two-grams.
+    if (parseParagraphs(&ctx->pairing, countTwoGram, ctx, line)) {
+        return EXIT_FAILURE;
+    }
 
-    // Tokenize the paragraph and store words in the 'words' array.
-    if (tokenizeWords(&paragraph, words, &total)) {
+    if (Temple_AgramFinish(ctx)) {
+        printf("ERROR: TwoGrams array is too small.\n");
         return EXIT_FAILURE;
     }
 
-    // Process the words to concatenate adjacent words.
-    if (parseWords(words, total)) {
+    // Output the two-grams.
+    outputTwoGrams(ctx);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Approximate Agram, with a fixed memory whatever the text.
+ * Reads the size of the heavy hitters table, then the text, and prints
+ * the heavy hitters with their estimated frequency and error bound.
+ * The counter gets its own region, sized from the table size.
+ * 
+ * @param allocator The allocator of the line buffer.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Sketch(TempleAllocator *allocator) {
+    int capacity;
+
+    // Read the size of the heavy hitters table.
+    if (scanf("%d", &capacity) != 1 || capacity <= 0) {
+        printf("ERROR: read heavy hitters size...\n");
         return EXIT_FAILURE;
     }
 
-    // Check if the total number of words is divisible by 3 and 5.
-    if (total % 3 || total % 5) total--;
+    char *line = allocator->alloc(allocator->self, BUFFER);
+    if (!line) {
+        printf("ERROR: Arena is too small.\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t size = Temple_SketchSize(capacity, SKETCH_WIDTH, SKETCH_DEPTH);
+    void *mem = malloc(size);
+    if (!mem) {
+        printf("ERROR: Failed to allocate the heavy hitters table...\n");
+        return EXIT_FAILURE;
+    }
 
-    // Check if the last pair has a single term.
-    TwoGram twoGrams[WORDS];
+    TempleSketch *ctx = Temple_SketchInit(mem, size, capacity, SKETCH_WIDTH, SKETCH_DEPTH);
 
-    // Find and count two-grams.
-    if (findTwoGrams(words, total, twoGrams)) {
+    // Estimate two-grams.
+    if (parseParagraphs(&ctx->pairing, countSketch, ctx, line)) {
+        free(mem);
         return EXIT_FAILURE;
     }
+    Temple_SketchFinish(ctx);
 
-    // Output the two-grams.
-    outputTwoGrams(twoGrams, total);
+    int heavyHitters = Temple_SketchUnique(ctx);
+
+    // Print the number of heavy hitters.
+    printf("%d\n", heavyHitters);
+
+    // Print each heavy hitter, its estimated frequency and its error bound.
+    for (int i = 0; i < heavyHitters; i++) {
+        const char *group;
+        u_int64_t frequency, error;
+
+        Temple_SketchGet(ctx, i, &group, &frequency, &error);
+        printf("%s %llu %llu\n", group, (unsigned long long)frequency, (unsigned long long)error);
+    }
+
+    free(mem);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief External Agram, with exact counts within a memory budget.
+ * Reads the budget in bytes, then the text, spilling two-grams to the
+ * local disk whenever the in-memory table is full. The counter gets its
+ * own region, sized from the budget rather than from the shared arena.
+ * 
+ * @param allocator The allocator of the line buffer.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Spill(TempleAllocator *allocator) {
+    long budget;
+
+    // Read the memory budget.
+    if (scanf("%ld", &budget) != 1 || budget <= 0) {
+        printf("ERROR: read memory budget...\n");
+        return EXIT_FAILURE;
+    }
+
+    int capacity = Temple_SpillCapacity(budget);
+    if (!capacity) {
+        printf("ERROR: Memory budget is too small.\n");
+        return EXIT_FAILURE;
+    }
+
+    char *line = allocator->alloc(allocator->self, BUFFER);
+    if (!line) {
+        printf("ERROR: Arena is too small.\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t size = Temple_SpillSize(capacity);
+    void *mem = malloc(size);
+    if (!mem) {
+        printf("ERROR: Failed to allocate the memory budget...\n");
+        return EXIT_FAILURE;
+    }
+
+    TempleSpill *ctx = Temple_SpillInit(mem, size, capacity);
+
+    // Find and count two-grams, spilling to disk.
+    if (parseParagraphs(&ctx->pairing, countSpill, ctx, line)) {
+        Temple_SpillClose(ctx);
+        free(mem);
+        return EXIT_FAILURE;
+    }
+
+    // Merge the spilled two-grams.
+    if (Temple_SpillFinish(ctx)) {
+        printf("ERROR: Merging two-grams failed.\n");
+        Temple_SpillClose(ctx);
+        free(mem);
+        return EXIT_FAILURE;
+    }
+
+    // Print the total number of unique two-grams.
+    printf("%llu\n", (unsigned long long)Temple_SpillUnique(ctx));
+
+    // Stream each unique two-gram and its frequency.
+    const char *group;
+    u_int64_t frequency;
+
+    while (!Temple_SpillNext(ctx, &group, &frequency)) {
+        printf("%s %llu\n", group, (unsigned long long)frequency);
+    }
+
+    // The stream also ends on a disk error, leaving two-grams out.
+    if (Temple_SpillFailed(ctx)) {
+        printf("ERROR: Reading two-grams failed.\n");
+        Temple_SpillClose(ctx);
+        free(mem);
+        return EXIT_FAILURE;
+    }
 
+    Temple_SpillClose(ctx);
+    free(mem);
     return EXIT_SUCCESS;
 }
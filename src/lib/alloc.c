@@ -0,0 +1,181 @@
+#include "../include/utils.h"
+
+/* ----------------------------------------------UTILS------------------------------------------------------- */
+
+/**
+ * @brief Round a size up to the alignment of malloc.
+ * 
+ * @param size The size to round.
+ * @return The aligned size.
+ */
+static size_t alignSize(size_t size) {
+    const size_t align = _Alignof(max_align_t);
+    return (size + align - 1) & ~(align - 1);
+}
+
+/**
+ * @brief Arena entry of the allocator interface.
+ */
+static void* arenaAlloc(void *self, size_t size) {
+    return Temple_ArenaAlloc((TempleArena*)self, size);
+}
+
+/**
+ * @brief Arena reset of the allocator interface.
+ */
+static void arenaReset(void *self) {
+    Temple_ArenaReset((TempleArena*)self);
+}
+
+/**
+ * @brief Pool entry of the allocator interface.
+ */
+static void* poolAlloc(void *self, size_t size) {
+    TemplePool *pool = (TemplePool*)self;
+    return (size <= pool->block) ? Temple_PoolAlloc(pool) : NULL;
+}
+
+/**
+ * @brief Pool reset of the allocator interface.
+ */
+static void poolReset(void *self) {
+    Temple_PoolReset((TemplePool*)self);
+}
+
+/* ----------------------------------------------UTILS------------------------------------------------------- */
+
+/**
+ * @brief Place an empty bump arena over a caller owned region.
+ * 
+ * @param arena The arena.
+ * @param mem   The region, aligned like malloc.
+ * @param size  The size of the region.
+ */
+void Temple_ArenaInit(TempleArena *arena, void *mem, size_t size) {
+    if (!arena) return;
+
+    arena->base = (char*)mem;
+    arena->size = mem ? size : 0;
+    arena->used = 0;
+}
+
+/**
+ * @brief Bump the arena by an aligned size.
+ * 
+ * @param arena The arena.
+ * @param size  The size requested.
+ * @return The memory, NULL if the arena is exhausted.
+ */
+void* Temple_ArenaAlloc(TempleArena *arena, size_t size) {
+    if (!arena || !size) return NULL;
+
+    size = alignSize(size);
+    // Check if the request fits in the rest of the region.
+    if (size > arena->size - arena->used) return NULL;
+
+    void *ptr = arena->base + arena->used;
+    arena->used += size;
+    return ptr;
+}
+
+/**
+ * @brief Release every allocation of the arena at once.
+ * 
+ * @param arena The arena.
+ */
+void Temple_ArenaReset(TempleArena *arena) {
+    if (arena) arena->used = 0;
+}
+
+/**
+ * @brief Allocator interface backed by an arena.
+ * 
+ * @param arena The arena.
+ * @return The allocator.
+ */
+TempleAllocator Temple_ArenaAllocator(TempleArena *arena) {
+    TempleAllocator allocator = { arenaAlloc, arenaReset, arena };
+    return allocator;
+}
+
+/**
+ * @brief Split a caller owned region into fixed-size blocks,
+ * handed out lazily so that no free list has to be built.
+ * 
+ * @param pool  The pool.
+ * @param mem   The region, aligned like malloc.
+ * @param size  The size of the region.
+ * @param block The size of a block.
+ */
+void Temple_PoolInit(TemplePool *pool, void *mem, size_t size, size_t block) {
+    if (!pool) return;
+
+    // A released block stores the link to the next one.
+    if (block < sizeof(void*)) block = sizeof(void*);
+
+    pool->base = (char*)mem;
+    pool->block = alignSize(block);
+    pool->count = mem ? size / pool->block : 0;
+    pool->next = 0;
+    pool->free = NULL;
+}
+
+/**
+ * @brief Allocate one block, reusing released blocks first.
+ * 
+ * @param pool The pool.
+ * @return The block, NULL if the pool is exhausted.
+ */
+void* Temple_PoolAlloc(TemplePool *pool) {
+    if (!pool) return NULL;
+
+    // Pop a released block.
+    if (pool->free) {
+        void *ptr = pool->free;
+        pool->free = *(void**)ptr;
+        return ptr;
+    }
+
+    // Hand out a block never used since the last reset.
+    if (pool->next < pool->count) {
+        return pool->base + pool->block * pool->next++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Give one block back to the pool.
+ * 
+ * @param pool The pool.
+ * @param ptr  The block, as returned by Temple_PoolAlloc.
+ */
+void Temple_PoolFree(TemplePool *pool, void *ptr) {
+    if (!pool || !ptr) return;
+
+    *(void**)ptr = pool->free;
+    pool->free = ptr;
+}
+
+/**
+ * @brief Release every block of the pool at once.
+ * 
+ * @param pool The pool.
+ */
+void Temple_PoolReset(TemplePool *pool) {
+    if (!pool) return;
+
+    pool->next = 0;
+    pool->free = NULL;
+}
+
+/**
+ * @brief Allocator interface backed by a pool.
+ * 
+ * @param pool The pool.
+ * @return The allocator.
+ */
+TempleAllocator Temple_PoolAllocator(TemplePool *pool) {
+    TempleAllocator allocator = { poolAlloc, poolReset, pool };
+    return allocator;
+}
@@ -1,11 +1,5 @@
 #include "../include/utils.h"
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static void         caesar           (char *code, int key);                                                  ////
-static void         vigenere         (char *code, char *key);                                                ////
-static char*        addnums          (char *str1, char *str2);                                               ////
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 /* ----------------------------------------------UTILS------------------------------------------------------- */
 
 /** 
@@ -28,9 +22,10 @@ static void reverse(char *code) {
 /**
  * @brief Handler for Caesar cipher command.
  * 
+ * @param allocator The allocator of the text buffer.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t Handler_Caesar(void) {
+static u_int8_t Handler_Caesar(TempleAllocator *allocator) {
     int key;
 
     // Read the encryption/decryption key.
@@ -38,15 +33,15 @@ static u_int8_t Handler_Caesar(void) {
         return EXIT_FAILURE;
     }
 
-    char txt[BUFFER];
+    char *txt = allocator->alloc(allocator->self, BUFFER);
 
     // Read the input string.
-    if (scanf("%s", txt) != 1) {
+    if (!txt || scanf("%9999s", txt) != 1) {
         return EXIT_FAILURE;
     }
 
     // Perform the Caesar cipher encryption/decryption.
-    caesar(txt, key);
+    Temple_Caesar(txt, key);
 
     printf("%s\n", txt);
     return EXIT_SUCCESS;
@@ -55,25 +50,28 @@ static u_int8_t Handler_Caesar(void) {
 /**
  * @brief Handler for Vigenere cipher command.
  * 
+ * @param allocator The allocator of the text buffer.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t Handler_VIgenere(void) {
+static u_int8_t Handler_VIgenere(TempleAllocator *allocator) {
     char key[INIT_LEN];
 
     // Read the encryption/decryption key.
-    if (scanf("%s", key) != 1) {
+    if (scanf("%14s", key) != 1) {
         return EXIT_FAILURE;
     }
 
-    char txt[BUFFER];
+    char *txt = allocator->alloc(allocator->self, BUFFER);
 
     // Read the input string.
-    if (scanf("%s", txt) != 1) {
+    if (!txt || scanf("%9999s", txt) != 1) {
         return EXIT_FAILURE;
     }
 
     // Perform the Vigenere cipher encryption/decryption.
-    vigenere(txt, key);
+    if (Temple_Vigenere(txt, key)) {
+        return EXIT_FAILURE;
+    }
 
     printf("%s\n", txt);
     return EXIT_SUCCESS;
@@ -82,9 +80,10 @@ static u_int8_t Handler_VIgenere(void) {
 /**
  * @brief Handler for addition command.
  * 
+ * @param allocator The allocator of the number buffers.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static u_int8_t Handler_AddNums(void) {
+static u_int8_t Handler_AddNums(TempleAllocator *allocator) {
     int key;
 
     // Read the integer key.
@@ -92,32 +91,32 @@ static u_int8_t Handler_AddNums(void) {
         return EXIT_FAILURE;
     }
 
-    char num1[BUFFER], num2[BUFFER];
+    char *num1 = allocator->alloc(allocator->self, BUFFER);
+    char *num2 = allocator->alloc(allocator->self, BUFFER);
 
     // Read the two number strings.
-    if (scanf("%s %s", num1, num2) != 2) {
+    if (!num1 || !num2 || scanf("%9999s %9999s", num1, num2) != 2) {
         return EXIT_FAILURE;
     }
 
     // Perform the Caesar cipher transformation.
-    caesar(num1, key % DIGITS);
-    caesar(num2, key % DIGITS);
-    // Reverse the transformed number strings.
-    reverse(num1);
-    reverse(num2);
+    Temple_Caesar(num1, key % DIGITS);
+    Temple_Caesar(num2, key % DIGITS);
+
+    char *sum = allocator->alloc(allocator->self, BUFFER + 1);
+
     // Calculate the sum of the transformed numbers.
-    char *sum = addnums(num1, num2);
+    if (!sum || Temple_AddNums(num1, num2, sum, BUFFER + 1)) {
+        return EXIT_FAILURE;
+    }
 
-    if (sum) {
-        int trailZeros = 0;
-        // Count and skip leading zeros in the result
-        for (int i = 0; sum[i] == '0'; i++) {
-            trailZeros++;
-        }
-        // Print the result without leading zeros
-        printf("%s\n", sum + trailZeros);
-        free(sum); // Sum is only printed!
+    int trailZeros = 0;
+    // Count and skip leading zeros in the result
+    for (int i = 0; sum[i] == '0'; i++) {
+        trailZeros++;
     }
+    // Print the result without leading zeros
+    printf("%s\n", sum + trailZeros);
 
     return EXIT_SUCCESS;
 }
@@ -130,7 +129,7 @@ static u_int8_t Handler_AddNums(void) {
  * @param[in, out] code The input string to be encoded/decoded.
  * @param[in] key       The encryption/decryption key.
  */
-static void caesar(char *code, int key) {
+void Temple_Caesar(char *code, int key) {
     // Check if the input is valid.
     if (!code) return;
 
@@ -158,10 +157,11 @@ static void caesar(char *code, int key) {
  * 
  * @param[in, out] code The input string to be encoded/decoded.
  * @param[in] key       The encryption/decryption key.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static void vigenere(char *code, char *key) {
+u_int8_t Temple_Vigenere(char *code, const char *key) {
     // Check if the input is valid.
-    if (!code || !key) return;
+    if (!code || !key || !*key) return EXIT_FAILURE;
 
     int len = strlen(key);
 
@@ -182,79 +182,77 @@ static void vigenere(char *code, char *key) {
             code[i] = (offset + DIGITS) % DIGITS + '0';
         }
     }
+
+    return EXIT_SUCCESS;
 }
 
 /** @brief Addition of two strings representing numbers.
- * Adds two strings representing numbers and returns the result.
+ * Adds two strings representing numbers into the caller buffer.
  * 
- * @param[in] str1 The first number string.
- * @param[in] str2 The second number string.
- * @return A dynamically allocated string representing the sum of str1 and str2.
+ * @param[in] num1  The first number string.
+ * @param[in] num2  The second number string.
+ * @param[out] sum  The buffer receiving the sum of num1 and num2.
+ * @param[in] size  The size of the sum buffer.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-static char* addnums(char *str1, char *str2) {
+u_int8_t Temple_AddNums(const char *num1, const char *num2, char *sum, size_t size) {
     // Check if the input is valid.
-    if (!str1 || !str2) return NULL;
+    if (!num1 || !num2 || !sum) return EXIT_FAILURE;
 
-    int len1 = strlen(str1);
-    int len2 = strlen(str2);
+    int len1 = strlen(num1);
+    int len2 = strlen(num2);
     int max = (len1 > len2) ? len1 : len2;
-    int min = (len1 > len2) ? len2 : len1;
 
-    // Alocate memory for the result.
-    char *add = (char*)malloc(max + 1);
-    if (!add) return NULL;
+    // Room for every digit, the final carry and the terminator.
+    if ((size_t)max + 2 > size) return EXIT_FAILURE;
 
     int carry = 0;
     int i = 0;
 
     while (i < max) {
-        int sum = carry;
-
-        // Add corresponding digits.
-        if (i < min) {
-            sum += (str1[i] - '0') + (str2[i] - '0');
-        } else if (len1 > len2) {
-            sum += (str1[i] - '0');
-        } else {
-            sum += (str2[i] - '0');
-        }
+        int add = carry;
+
+        // Add corresponding digits, starting from the least significant.
+        if (i < len1) add += num1[len1 - i - 1] - '0';
+        if (i < len2) add += num2[len2 - i - 1] - '0';
 
         // Digit after the addition.
-        add[i] = (sum % 10) + '0';
+        sum[i] = (add % BASE10) + '0';
         // Carry for the next digits addition.
-        carry = sum / 10;
+        carry = add / BASE10;
         i++;
     }
 
     // Add the Most Significant Digit, carry exists.
     if (carry > 0)
-        add[i++] = carry + '0';
+        sum[i++] = carry + '0';
 
-    add[i] = '\0';
-    reverse(add);
-    return add;
+    sum[i] = '\0';
+    reverse(sum);
+    return EXIT_SUCCESS;
 }
 
 /**
  * @brief Main function to solve MAGIC CIPHER.
  * Reads a command and invokes the corresponding handler function.
  * 
+ * @param allocator The allocator of the command buffers.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-u_int8_t Cipher(void) {
-    char CMD[BUFFER];
+u_int8_t Cipher(TempleAllocator *allocator) {
+    char CMD[INIT_LEN];
 
-    if (scanf("%s", CMD) != 1) {
+    if (scanf("%14s", CMD) != 1) {
         fprintf(stderr, "ERROR: INVALID COMMAND...\n");
         exit(EXIT_FAILURE);
     }
 
     if (!strcmp(CMD, "caesar")) {
-        if (Handler_Caesar()) return EXIT_FAILURE;
+        if (Handler_Caesar(allocator)) return EXIT_FAILURE;
     } else if (!strcmp(CMD, "vigenere")) {
-        if (Handler_VIgenere()) return EXIT_FAILURE;
+        if (Handler_VIgenere(allocator)) return EXIT_FAILURE;
     } else if (!strcmp(CMD, "addition")) {
-        if (Handler_AddNums()) return EXIT_FAILURE;
+        if (Handler_AddNums(allocator)) return EXIT_FAILURE;
     } else {
         fprintf(stderr, "UNKNOWN COMMAND: %s\n", CMD);
         return EXIT_FAILURE;
@@ -76,6 +76,27 @@ static char moveB(char *code, int length) {
     return (palindrome ? (prime ? 'L' : 'R') : (prime ? 'U' : 'D'));
 }
 
+/**
+ * @brief Check that a 'c' word holds its length, its step and
+ * enough digits for the circular sum.
+ * 
+ * @param code   The input string.
+ * @param length The length of the string.
+ * @return true if moveC can process the word, false otherwise.
+ */
+static bool validC(const char *code, int length) {
+    if (length < 3 || !ISDIGIT(code[1]) || !ISDIGIT(code[2])) return false;
+
+    int len = code[1] - '0';
+    if (len == 0 || length < len + 3) return false;
+
+    for (int i = 3; i < len + 3; i++) {
+        if (!ISDIGIT(code[i])) return false;
+    }
+
+    return true;
+}
+
 /**
  * @brief Calculate the direction based on the input string and length.
  * 
@@ -96,17 +117,85 @@ static char moveC(char *code) {
     return moves[sCircular % DIRS];
 }
 
+/**
+ * @brief Walk the magic temple, numbering each visited cell.
+ * Directions without a clear winner keep the current cell.
+ * Cells hold a char, so the path is limited to MAX_STEPS cells.
+ * 
+ * @param code The magic words separated by spaces.
+ * @param grid The N * M temple matrix, row-major.
+ * @param N    The number of rows.
+ * @param M    The number of columns.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+u_int8_t Temple_Path(const char *code, char *grid, int N, int M) {
+    // Check if the input is valid.
+    if (!code || !grid || N <= 0 || M <= 0) return EXIT_FAILURE;
+
+    // Initialize the temple matrix with zeros.
+    memset(grid, 0, (size_t)N * M);
+
+    int row = 0, col = 0, mv = 1;
+    grid[0] = (char)(mv++);
+
+    // Process each magic word, moving one cell per word.
+    while (*code) {
+        code += strspn(code, " ");
+        int length = strcspn(code, " ");
+        if (!length) break;
+
+        if (length >= LENGTH) {
+            return EXIT_FAILURE;
+        }
+
+        char word[LENGTH];
+        memcpy(word, code, length);
+        word[length] = '\0';
+        code += length;
+
+        char dir;
+        if (word[0] == 'a') {
+            if (length < 5) return EXIT_FAILURE;
+            dir = moveA(word[1], word[2], word[3], word[4]);
+        } else if (word[0] == 'b') {
+            if (length < 3) return EXIT_FAILURE;
+            dir = moveB(word, length);
+        } else if (word[0] == 'c') {
+            if (!validC(word, length)) return EXIT_FAILURE;
+            dir = moveC(word);
+        } else {
+            continue;
+        }
+
+        // Calculate the new position based on the direction.
+        if (dir == 'L') col--;
+        if (dir == 'U') row--;
+        if (dir == 'R') col++;
+        if (dir == 'D') row++;
+
+        // The path must stay inside the temple, without wrapping around rows.
+        if (row < 0 || row >= N || col < 0 || col >= M || mv > MAX_STEPS) {
+            return EXIT_FAILURE;
+        }
+
+        grid[row * M + col] = (char)(mv++);
+    }
+
+    return EXIT_SUCCESS;
+}
+
 /**
  * @brief Main function to solve MAGIC WORDS.
  * Reads a command and invokes the corresponding handler function.
  * 
+ * @param allocator The allocator of the temple matrix.
  * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-u_int8_t Words(void) {
+u_int8_t Words(TempleAllocator *allocator) {
     int N, M;
 
     // Read input values N and M.
-    if (scanf("%d %d\n", &N, &M) != 2) {
+    if (scanf("%d %d\n", &N, &M) != 2 || N <= 0 || M <= 0) {
         printf("ERROR: read input size temple...\n");
         return EXIT_FAILURE;
     }
@@ -118,48 +207,22 @@ u_int8_t Words(void) {
         return EXIT_FAILURE;
     }
 
-    char temple[N][M];
-    // Initialize the temple matrix with zeros.
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < M; j++) {
-            temple[i][j] = 0;
-        }
-    }
-    
-    int k = 0;
-    char dirs[INIT_LEN];
-
-    // Tokenize the input command and process each token.
-    char *code, *saveptr;
-    code = strtok_r(string, " ", &saveptr); // Save state between calls.
-
-    while (code) {
-        int length = strlen(code);  //          x1       x2       x3       x4
-        if (code[0] == 'a') dirs[k++] = moveA(code[1], code[2], code[3], code[4]);
-        if (code[0] == 'b') dirs[k++] = moveB(code, length);
-        if (code[0] == 'c') dirs[k++] = moveC(code);
-        code = strtok_r(NULL, " ", &saveptr);
+    char *temple = allocator->alloc(allocator->self, (size_t)N * M);
+    if (!temple) {
+        printf("ERROR: temple is too large...\n");
+        return EXIT_FAILURE;
     }
 
-    // Initialize an array of pointers to move within the temple matrix.
-    char *move[INIT_LEN] = {0};
-    move[0] = &(temple[0][0]);
-
-    // Calculate new positions based on directions and assign values to the temple matrix.
-    for (int i = 0; i <= k; i++) {
-        if (dirs[i] == 'L') move[i + 1] = move[i] - 1;
-        if (dirs[i] == 'U') move[i + 1] = move[i] - M;
-        if (dirs[i] == 'R') move[i + 1] = move[i] + 1;
-        if (dirs[i] == 'D') move[i + 1] = move[i] + M;
+    // Walk the temple following the magic words.
+    if (Temple_Path(string, temple, N, M)) {
+        printf("ERROR: invalid path through the temple...\n");
+        return EXIT_FAILURE;
     }
-    
-    // Assign values to the temple matrix.
-    for (int i = 0, mv = 1; i <= k; i++) *move[i] = (char)(mv++);
 
     // Print the resulting matrix temple path.
     for (int i = 0; i < N; i++) {
         for (int j = 0; j < M; j++) {
-            printf("%d ", temple[i][j]);
+            printf("%d ", temple[i * M + j]);
         }
         printf("\n");
     }
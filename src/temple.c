@@ -8,21 +8,46 @@ int main(void) {
         return EXIT_FAILURE;
     }
 
+    // Every task allocates from one region, released at once.
+    void *region = malloc(ARENA);
+    if (!region) {
+        printf("ERROR: Failed to allocate the arena...\n");
+        return EXIT_FAILURE;
+    }
+
+    TempleArena arena;
+    TemplePool pool;
+    Temple_ArenaInit(&arena, region, ARENA);
+    TempleAllocator allocator = Temple_ArenaAllocator(&arena);
+    u_int8_t status;
+
     // Execute the task based on the provided task ID.
     switch (taskID) {
         case 1:
-            Words();  // find path through magic temple
+            status = Words(&allocator);  // find path through magic temple
             break;
         case 2:
-            Cipher(); // caesar, vigenere and addition
+            // Cipher only asks for text buffers, served as fixed-size blocks
+            // carved out of the arena, so the region has a single owner.
+            Temple_PoolInit(&pool, Temple_ArenaAlloc(&arena, ARENA), ARENA, BUFFER + 1);
+            allocator = Temple_PoolAllocator(&pool);
+            status = Cipher(&allocator); // caesar, vigenere and addition
             break;
         case 3:
-            Agram();  // 2-gram frequnecy
+            status = Agram(&allocator);  // 2-gram frequnecy
+            break;
+        case 4:
+            status = Sketch(&allocator); // approximate 2-gram frequency
+            break;
+        case 5:
+            status = Spill(&allocator);  // external 2-gram frequency
             break;
         default:
             printf("UNDEFINED TASK ID...\n"); // Handle undefined task IDs.
+            free(region);
             return EXIT_FAILURE;
     }
 
-    return EXIT_SUCCESS;
+    free(region);
+    return status;
 }